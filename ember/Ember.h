@@ -1,15 +1,31 @@
 #pragma once
 
 #include <chrono>
+#include <optional>
 
 #include "ember/core/SceneManager.h"
 #include "ember/gpu/VulkanInstance.h"
+#include "ember/graphics/FramePacket.h"
+#include "ember/util/FrameTiming.h"
+#include "ember/util/ThreadPool.h"
 
 namespace ember {
 
     struct AppInfo {
         const char* app_name;
         uint32_t version;
+        // Number of worker threads used to run independent systems in parallel
+        size_t worker_threads = util::ThreadPool::default_worker_count();
+        // Seconds simulated by every World::run, e.g. 1/60. 0 (the default) runs once
+        // per frame with the measured frame time instead
+        float fixed_timestep = 0.0f;
+        // Fixed steps run at most per frame before the simulation starts falling behind
+        size_t max_substeps = 8;
+        // Frames per second the main loop is held to, 0 (the default) for no limit
+        float max_frame_rate = 0.0f;
+        // Run the scenes without any graphics: no Vulkan instance is created and no
+        // frame packets are extracted. Also enabled by passing --headless.
+        bool headless = false;
     };
 
     class Ember {
@@ -22,11 +38,24 @@ namespace ember {
         );
         int run();
 
+        inline bool headless() const { return m_headless; }
+
+        // Packets of the render state published after every simulated frame, for a
+        // renderer running on its own thread. Extraction starts once that renderer
+        // first acquires a packet. Closed from the start when headless.
+        inline graphics::FramePacketBuffer& frame_packets() { return m_frame_packets; }
+
     private:
         int m_argc;
         const char* const* m_argv;
-        std::chrono::high_resolution_clock::time_point m_last_world_update;
+        bool m_headless;
+        std::chrono::steady_clock::time_point m_last_world_update;
+        std::optional<util::FixedTimestep> m_fixed_timestep;
+        util::FrameLimiter m_frame_limiter;
         std::shared_ptr<const gpu::VulkanInstance> m_vulkan_instance;
+        std::shared_ptr<util::ThreadPool> m_thread_pool;
+        graphics::FramePacketBuffer m_frame_packets;
+        uint64_t m_frame = 0;
 
         core::SceneManager m_scene_manager;
 
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Entity.h"
+#include "EntitySet.h"
+#include "Storage.h"
+#include "StorageHooks.h"
+#include "TypeId.h"
+
+namespace ember::ecs {
+
+    // An archetype is the set of all entities that share the exact same set of
+    // archetype-stored components. Each archetype stores its entities in fixed size
+    // chunks laid out as SoA columns so systems touching several components of the
+    // same entity stream through contiguous memory instead of hopping between storages.
+    //
+    //   chunk: [ Entity x capacity | column 0 x capacity | column 1 x capacity | ... ]
+    class Archetype {
+    public:
+        using ColumnId = uint32_t;
+
+        static constexpr size_t CHUNK_SIZE = 16 * 1024;
+        static constexpr size_t COLUMN_ALIGNMENT = 64;
+
+        struct ColumnInfo {
+            size_t size;
+            size_t alignment;
+        };
+
+        Archetype(std::vector<ColumnId> columns, const std::vector<ColumnInfo>& column_info);
+
+        inline const std::vector<ColumnId>& columns() const { return m_columns; }
+        inline size_t size() const { return m_size; }
+        inline size_t chunk_capacity() const { return m_capacity; }
+        inline size_t chunk_count() const { return m_chunks.size(); }
+        inline size_t chunk_size(size_t chunk) const {
+            const auto first = chunk * m_capacity;
+            return (m_size > first) ? std::min(m_capacity, m_size - first) : 0;
+        }
+
+        // Index of the column within this archetype or -1 if the archetype does not hold it
+        int column_index(ColumnId column) const;
+        inline bool has_column(ColumnId column) const { return column_index(column) >= 0; }
+
+        inline Entity* entities(size_t chunk) {
+            return reinterpret_cast<Entity*>(m_chunks[chunk]->bytes.data());
+        }
+        inline const Entity* entities(size_t chunk) const {
+            return reinterpret_cast<const Entity*>(m_chunks[chunk]->bytes.data());
+        }
+
+        inline std::byte* column_data(size_t chunk, size_t index) {
+            return m_chunks[chunk]->bytes.data() + m_column_offsets[index];
+        }
+        inline const std::byte* column_data(size_t chunk, size_t index) const {
+            return m_chunks[chunk]->bytes.data() + m_column_offsets[index];
+        }
+
+        std::byte* get(size_t row, size_t index);
+        const std::byte* get(size_t row, size_t index) const;
+        inline Entity entity(size_t row) const { return entities(row / m_capacity)[row % m_capacity]; }
+
+        // Append an entity with uninitialized column data and return its row
+        size_t push(Entity e);
+
+        // Remove the row by moving the last row into it. Returns the entity that now
+        // occupies the row or INVALID_ENTITY if the removed row was the last one.
+        Entity swap_remove(size_t row);
+
+        // Archetype graph edges, cached so repeated add/remove transitions are O(1)
+        std::unordered_map<ColumnId, size_t> add_edges;
+        std::unordered_map<ColumnId, size_t> remove_edges;
+
+    private:
+        struct alignas(COLUMN_ALIGNMENT) Chunk {
+            std::array<std::byte, CHUNK_SIZE> bytes;
+        };
+
+        std::vector<ColumnId> m_columns;
+        std::vector<size_t> m_column_sizes;
+        std::vector<size_t> m_column_offsets;
+        size_t m_capacity;
+        size_t m_size;
+        std::vector<std::unique_ptr<Chunk>> m_chunks;
+    };
+
+    // Owns every archetype of a world and tracks where each entity lives. Storages
+    // for individual components are thin views (see ArchetypeStorage) onto a shared registry.
+    class ArchetypeRegistry {
+    public:
+        using ColumnId = Archetype::ColumnId;
+
+        ArchetypeRegistry();
+        ArchetypeRegistry(const ArchetypeRegistry&) = delete;
+        ArchetypeRegistry& operator=(const ArchetypeRegistry&) = delete;
+
+        template<typename T>
+        ColumnId register_column() {
+            static_assert(std::is_trivially_copyable_v<T>, "Archetype components are moved with memcpy");
+            static_assert(alignof(T) <= Archetype::COLUMN_ALIGNMENT);
+
+            const auto id = type_id<T>();
+            if (id >= m_column_ids.size()) m_column_ids.resize(id + 1, NO_COLUMN);
+            if (m_column_ids[id] != NO_COLUMN) return m_column_ids[id];
+
+            const auto column = ColumnId(m_column_info.size());
+            m_column_info.push_back({ sizeof(T), alignof(T) });
+            m_column_ids[id] = column;
+            return column;
+        }
+
+        template<typename T>
+        ColumnId column_id() const {
+            const auto id = type_id<T>();
+            if ((id >= m_column_ids.size()) || (m_column_ids[id] == NO_COLUMN)) {
+                throw std::out_of_range("Attempted to access unregistered archetype column!");
+            }
+            return m_column_ids[id];
+        }
+
+        bool contains(Entity e, ColumnId column) const;
+        std::byte* get(Entity e, ColumnId column);
+        const std::byte* get(Entity e, ColumnId column) const;
+
+        // Copy the component into the entity moving it to a new archetype if needed
+        void insert(Entity e, ColumnId column, const void* data);
+        void remove(Entity e, ColumnId column);
+
+        inline size_t archetype_count() const { return m_archetypes.size(); }
+        inline Archetype& archetype(size_t index) { return m_archetypes[index]; }
+        inline const Archetype& archetype(size_t index) const { return m_archetypes[index]; }
+
+        // Call fn(std::span<const Entity>, std::span<T>...) for each chunk of every archetype
+        // that holds all of the requested components.
+        template<typename... T, typename Fn>
+        void each_chunk(Fn&& fn) {
+            const std::array<ColumnId, sizeof...(T)> columns { column_id<std::remove_const_t<T>>()... };
+
+            for (auto& archetype : m_archetypes) {
+                std::array<int, sizeof...(T)> indices;
+                bool matches = true;
+                for (auto i = 0; i < columns.size(); i++) {
+                    indices[i] = archetype.column_index(columns[i]);
+                    matches &= (indices[i] >= 0);
+                }
+                if (!matches) continue;
+
+                for (auto chunk = 0; chunk < archetype.chunk_count(); chunk++) {
+                    const auto count = archetype.chunk_size(chunk);
+                    if (count == 0) continue;
+                    call_chunk<T...>(fn, archetype, chunk, count, indices, std::index_sequence_for<T...>());
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t NO_ARCHETYPE = ~uint32_t(0);
+        struct Location {
+            uint32_t archetype = NO_ARCHETYPE;
+            uint32_t row = 0;
+        };
+
+        std::vector<Archetype::ColumnInfo> m_column_info;
+        // Indexed by TypeId
+        static constexpr ColumnId NO_COLUMN = ~ColumnId(0);
+        std::vector<ColumnId> m_column_ids;
+
+        std::vector<Archetype> m_archetypes;
+        std::map<std::vector<ColumnId>, size_t> m_archetype_index;
+        std::vector<Location> m_locations;
+
+        size_t find_or_create_archetype(std::vector<ColumnId> columns);
+        size_t archetype_with(size_t from, ColumnId column);
+        size_t archetype_without(size_t from, ColumnId column);
+        void move_entity(Entity e, size_t to);
+        Location& location(Entity e);
+
+        template<typename... T, typename Fn, size_t... I>
+        static void call_chunk(
+            Fn& fn,
+            Archetype& archetype,
+            size_t chunk,
+            size_t count,
+            const std::array<int, sizeof...(T)>& indices,
+            std::index_sequence<I...>
+        ) {
+            fn(
+                std::span<const Entity>(archetype.entities(chunk), count),
+                std::span<T>(reinterpret_cast<T*>(archetype.column_data(chunk, indices[I])), count)...
+            );
+        }
+    };
+
+    // ComponentStorage adaptor that places a component in the archetype chunks of the
+    // registry it is bound to. World binds storages to its registry when the component
+    // is added; an unbound storage lazily creates a private registry so it can still be
+    // used standalone.
+    //
+    // Experimental: no component of the engine is stored this way yet. The storage has
+    // no change ticks, so Changed and Added view filters reject it, and no snapshots, so
+    // worlds holding it cannot be saved or rolled back.
+    template<typename T>
+    class ArchetypeStorage {
+    public:
+        using Component = T;
+        using reference = T&;
+        using const_reference = const T&;
+
+        template<bool Const>
+        class Iterator {
+        public:
+            using value_type = T;
+            using difference_type = ptrdiff_t;
+            using reference = std::conditional_t<Const, const T&, T&>;
+            using Registry = std::conditional_t<Const, const ArchetypeRegistry, ArchetypeRegistry>;
+
+            Iterator() = default;
+            Iterator(Registry* registry, Archetype::ColumnId column, size_t archetype):
+                m_registry(registry), m_column(column), m_archetype(archetype), m_chunk(0)
+            {
+                find_valid_chunk();
+            }
+
+            reference operator*() const { return *m_ptr; }
+            auto operator->() const { return m_ptr; }
+
+            Iterator& operator++() {
+                if (++m_ptr == m_chunk_end) {
+                    m_chunk++;
+                    find_valid_chunk();
+                }
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            bool operator==(const Iterator& rhs) const {
+                return (m_archetype == rhs.m_archetype) && (m_ptr == rhs.m_ptr);
+            }
+            bool operator!=(const Iterator& rhs) const {
+                return !(*this == rhs);
+            }
+
+        private:
+            using Pointer = std::conditional_t<Const, const T*, T*>;
+
+            Registry* m_registry = nullptr;
+            Archetype::ColumnId m_column = 0;
+            size_t m_archetype = 0;
+            size_t m_chunk = 0;
+            Pointer m_ptr = nullptr;
+            Pointer m_chunk_end = nullptr;
+
+            void find_valid_chunk() {
+                m_ptr = m_chunk_end = nullptr;
+                if (m_registry == nullptr) return;
+
+                for (; m_archetype < m_registry->archetype_count(); m_archetype++, m_chunk = 0) {
+                    auto& archetype = m_registry->archetype(m_archetype);
+                    const auto index = archetype.column_index(m_column);
+                    if (index < 0) continue;
+
+                    for (; m_chunk < archetype.chunk_count(); m_chunk++) {
+                        const auto count = archetype.chunk_size(m_chunk);
+                        if (count == 0) continue;
+
+                        m_ptr = reinterpret_cast<Pointer>(archetype.column_data(m_chunk, index));
+                        m_chunk_end = m_ptr + count;
+                        return;
+                    }
+                }
+            }
+        };
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+        static_assert(std::forward_iterator<iterator>);
+
+        void bind(ArchetypeRegistry& registry) {
+            if (m_registry == &registry) return;
+            if (m_size != 0) throw std::logic_error("Cannot rebind a non-empty archetype storage");
+
+            m_owned_registry.reset();
+            m_registry = &registry;
+            m_column = registry.register_column<T>();
+        }
+
+        inline bool contains(Entity e) const { return m_valid.contains(e); }
+        inline const EntitySet& entities() const { return m_valid; }
+
+        void insert(Entity e, const Component& c) {
+            // Same id with a stale generation is removed first so it is counted and
+            // reported to the hooks only once. Dead handles of an older generation are
+            // ignored rather than overwriting the live entity.
+            const auto current = m_valid.iter_from(e.id);
+            if ((current != m_valid.end()) && ((*current).id == e.id) && ((*current).generation != e.generation)) {
+                if (!newer_generation(e, *current)) return;
+                remove(*current);
+            }
+
+            registry().insert(e, m_column, &c);
+            const auto added = !m_valid.contains(e);
+            if (added) m_size++;
+            m_valid.insert(e);
+            if (added) m_hooks.inserted(e);
+            else m_hooks.replaced(e);
+        }
+
+        void remove(Entity e) {
+            if (!m_valid.contains(e)) throw std::out_of_range("Attempted to remove invalid component!");
+            m_hooks.removing(e);
+            m_registry->remove(e, m_column);
+            m_valid.remove(e);
+            m_size--;
+        }
+
+        const T& operator[](Entity e) const {
+            return *reinterpret_cast<const T*>(m_registry->get(e, m_column));
+        }
+        T& operator[](Entity e) {
+            return *reinterpret_cast<T*>(m_registry->get(e, m_column));
+        }
+
+        const T& at(Entity e) const {
+            if (!m_valid.contains(e)) throw std::out_of_range("Attempted to access invalid component!");
+            return (*this)[e];
+        }
+        T& at(Entity e) {
+            if (!m_valid.contains(e)) throw std::out_of_range("Attempted to access invalid component!");
+            return (*this)[e];
+        }
+
+        const_iterator begin() const {
+            return const_iterator(m_registry, m_column, 0);
+        }
+        iterator begin() {
+            return iterator(m_registry, m_column, 0);
+        }
+
+        const_iterator end() const {
+            return const_iterator(nullptr, m_column, archetype_count());
+        }
+        iterator end() {
+            return iterator(nullptr, m_column, archetype_count());
+        }
+
+        inline size_t size() const { return m_size; }
+
+        inline StorageHooks& hooks() { return m_hooks; }
+
+    private:
+        std::shared_ptr<ArchetypeRegistry> m_owned_registry;
+        ArchetypeRegistry* m_registry = nullptr;
+        Archetype::ColumnId m_column = 0;
+        EntitySet m_valid;
+        size_t m_size = 0;
+        StorageHooks m_hooks;
+
+        ArchetypeRegistry& registry() {
+            if (m_registry == nullptr) {
+                m_owned_registry = std::make_shared<ArchetypeRegistry>();
+                m_registry = m_owned_registry.get();
+                m_column = m_registry->register_column<T>();
+            }
+            return *m_registry;
+        }
+
+        size_t archetype_count() const {
+            return (m_registry != nullptr) ? m_registry->archetype_count() : 0;
+        }
+    };
+
+    static_assert(ComponentStorage<ArchetypeStorage<int>>);
+
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Component.h"
+#include "Entity.h"
+#include "StorageHooks.h"
+#include "View.h"
+
+namespace ember::ecs {
+
+    // Persistent query over the entities holding every component of T... Unlike
+    // World::query() or a View the matching entities are kept in a packed array that
+    // storage hooks update as components are inserted and removed, so iterating costs
+    // O(matches) no matter how sparse the match is. Usually obtained from
+    // World::cached_query() which keeps it alive for the lifetime of the world.
+    //
+    // Inserting into or removing from a queried storage while iterating invalidates
+    // the iteration.
+    template<typename... T>
+    class CachedQuery {
+    public:
+        static_assert(sizeof...(T) > 0);
+        static_assert((Component<std::remove_const_t<T>> && ...));
+        static_assert((HookedStorage<typename std::remove_const_t<T>::Storage> && ...));
+
+        using value_type = std::tuple<Entity, ViewReference<T>...>;
+
+        CachedQuery() = default;
+        CachedQuery(CachedQuery&& other) {
+            if (other.attached()) throw std::logic_error("Cannot move an attached CachedQuery");
+        }
+        CachedQuery(const CachedQuery&) = delete;
+        CachedQuery& operator=(const CachedQuery&) = delete;
+
+        ~CachedQuery() {
+            if (attached()) detach(std::index_sequence_for<T...>());
+        }
+
+        // Fill the query from the storages and start tracking them
+        void attach(typename std::remove_const_t<T>::Storage&... storages) {
+            if (attached()) throw std::logic_error("CachedQuery is already attached");
+            m_storages = std::make_tuple(&storages...);
+
+            View<const T...>(storages...).each([this](Entity e, const auto&...) { add(e); });
+            hook(std::index_sequence_for<T...>());
+        }
+
+        inline bool attached() const { return std::get<0>(m_storages) != nullptr; }
+
+        inline std::span<const Entity> entities() const { return m_entities; }
+        inline size_t size() const { return m_entities.size(); }
+
+        bool contains(Entity e) const {
+            return (e.id < m_index.size())
+                && (m_index[e.id] != NO_INDEX)
+                && (m_entities[m_index[e.id]].raw == e.raw);
+        }
+
+        // Call fn(Entity, T&...) for every matching entity
+        template<typename Fn>
+        void each(Fn&& fn) const {
+            for (const auto e : m_entities) std::apply(fn, get(e, std::index_sequence_for<T...>()));
+        }
+
+        class iterator {
+        public:
+            using value_type = CachedQuery::value_type;
+            using difference_type = ptrdiff_t;
+
+            iterator() = default;
+            iterator(const CachedQuery* query, const Entity* entity): m_query(query), m_entity(entity) { }
+
+            value_type operator*() const {
+                return m_query->get(*m_entity, std::index_sequence_for<T...>());
+            }
+
+            iterator& operator++() {
+                m_entity++;
+                return *this;
+            }
+
+            iterator operator++(int) {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            bool operator==(const iterator& rhs) const { return m_entity == rhs.m_entity; }
+            bool operator!=(const iterator& rhs) const { return m_entity != rhs.m_entity; }
+
+        private:
+            const CachedQuery* m_query = nullptr;
+            const Entity* m_entity = nullptr;
+        };
+        static_assert(std::forward_iterator<iterator>);
+
+        iterator begin() const { return iterator(this, m_entities.data()); }
+        iterator end() const { return iterator(this, m_entities.data() + m_entities.size()); }
+
+    private:
+        static constexpr uint32_t NO_INDEX = ~uint32_t(0);
+
+        std::tuple<typename std::remove_const_t<T>::Storage*...> m_storages {};
+        std::array<StorageHooks::HookId, 2 * sizeof...(T)> m_hooks {};
+
+        std::vector<Entity> m_entities;
+        // Entity id -> index into m_entities
+        std::vector<uint32_t> m_index;
+
+        template<size_t... I>
+        inline value_type get(Entity e, std::index_sequence<I...>) const {
+            // Const components go through the const storage so they are not marked changed
+            return value_type(e, static_cast<ViewStorage<T>&>(*std::get<I>(m_storages))[e]...);
+        }
+
+        template<size_t... I>
+        inline bool matches(Entity e, std::index_sequence<I...>) const {
+            return (std::get<I>(m_storages)->contains(e) && ...);
+        }
+
+        void add(Entity e) {
+            if (e.id >= m_index.size()) m_index.resize(e.id + 1, NO_INDEX);
+            m_index[e.id] = uint32_t(m_entities.size());
+            m_entities.push_back(e);
+        }
+
+        void remove(Entity e) {
+            const auto index = m_index[e.id];
+            const auto last = m_entities.back();
+            m_entities[index] = last;
+            m_index[last.id] = index;
+            m_entities.pop_back();
+            m_index[e.id] = NO_INDEX;
+        }
+
+        template<size_t... I>
+        void hook(std::index_sequence<I...>) {
+            ((m_hooks[2 * I] = std::get<I>(m_storages)->hooks().on_insert([this](Entity e) {
+                if (!contains(e) && matches(e, std::index_sequence_for<T...>())) add(e);
+            })), ...);
+            ((m_hooks[2 * I + 1] = std::get<I>(m_storages)->hooks().on_remove([this](Entity e) {
+                if (contains(e)) remove(e);
+            })), ...);
+        }
+
+        template<size_t... I>
+        void detach(std::index_sequence<I...>) {
+            (std::get<I>(m_storages)->hooks().remove_hook(m_hooks[2 * I]), ...);
+            (std::get<I>(m_storages)->hooks().remove_hook(m_hooks[2 * I + 1]), ...);
+        }
+    };
+
+}
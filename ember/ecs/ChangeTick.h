@@ -0,0 +1,51 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+
+#include "Entity.h"
+
+namespace ember::ecs {
+
+    // World time used for change detection. The world advances its tick at the start of
+    // every phase so all systems of a phase share one tick, and storages stamp components
+    // with the current tick whenever they are inserted or mutably accessed.
+    using Tick = uint32_t;
+
+    // Ticks wrap around so they are compared through their signed difference, which
+    // is correct as long as the two ticks are less than 2^31 apart.
+    constexpr bool tick_newer_than(Tick tick, Tick since) {
+        return int32_t(tick - since) > 0;
+    }
+
+    struct ComponentTicks {
+        Tick added = 0;
+        Tick changed = 0;
+
+        constexpr bool added_since(Tick since) const { return tick_newer_than(added, since); }
+        constexpr bool changed_since(Tick since) const { return tick_newer_than(changed, since); }
+    };
+
+    // Storage that remembers the tick of its last insertion, removal or mutable access,
+    // so a whole storage can be skipped when nothing in it changed. The world binds the
+    // tick source with bind_ticks().
+    //
+    // Mutable accessors stamp the storage through touch(), which only writes the stamp
+    // when the tick moved. Loops handing components to several threads call touch()
+    // once before starting them, after which the accessors only read the stamp.
+    template<typename S>
+    concept ModifiedStorage = requires(const S const_s, S s, const Tick& tick) {
+        { const_s.modified_tick() } -> std::same_as<Tick>;
+        { s.touch() } -> std::same_as<Tick>;
+        s.bind_ticks(tick);
+    };
+
+    // Storage whose components carry ComponentTicks, required by the Changed<T> and
+    // Added<T> view filters.
+    template<typename S>
+    concept TrackedStorage = ModifiedStorage<S> && requires(const S const_s, S s, Entity e) {
+        { const_s.ticks(e) } -> std::same_as<const ComponentTicks&>;
+        s.mark_all_changed();
+    };
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Component.h"
+#include "Entity.h"
+#include "TransformComponent.h"
+#include "TypeId.h"
+#include "World.h"
+
+namespace ember::ecs {
+
+    class CommandBuffer;
+
+    namespace detail {
+        class CommandQueueBase {
+        public:
+            virtual ~CommandQueueBase() = default;
+
+            virtual bool empty() const = 0;
+            virtual void clear() = 0;
+
+            // Apply this queue together with the queues for the same component of every
+            // buffer, leaving all of them empty
+            virtual void apply(World& world, std::span<CommandBuffer* const> buffers) = 0;
+        };
+
+        template<Component T>
+        class CommandQueue;
+    }
+
+    // Records structural changes (spawns, despawns, component inserts and removals) so
+    // systems running in parallel never mutate storages directly. Entities are reserved
+    // immediately so a spawned entity can be given components in the same phase.
+    //
+    // Commands are applied in bulk: every command for the same storage is applied in one
+    // go, ordered by entity to walk the storage in order, and despawns are applied last.
+    // Commands recorded for one entity keep their relative order.
+    class CommandBuffer {
+    public:
+        explicit CommandBuffer(World& world): m_world(&world) { }
+
+        CommandBuffer(const CommandBuffer&) = delete;
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        Entity create_entity() {
+            const auto e = m_world->reserve_entity();
+            insert<TransformComponent>(e, {});
+            return e;
+        }
+
+        void destroy_entity(Entity e) {
+            m_destroyed.push_back(e);
+        }
+
+        template<Component T>
+        void insert(Entity e, const T& c) {
+            queue<T>().push({ e, true, c });
+        }
+
+        template<Component T>
+        void remove(Entity e) {
+            queue<T>().push({ e, false, T() });
+        }
+
+        bool empty() const;
+
+        void apply() {
+            CommandBuffer* self = this;
+            apply(*m_world, std::span(&self, 1));
+        }
+
+        // Merge and apply the commands of several buffers of the same world (usually one
+        // per thread), leaving them empty but with their memory kept for reuse
+        static void apply(World& world, std::span<CommandBuffer* const> buffers);
+
+    private:
+        template<Component T>
+        friend class detail::CommandQueue;
+
+        World* m_world;
+        std::vector<Entity> m_destroyed;
+        // Indexed by the TypeId of the component
+        std::vector<std::unique_ptr<detail::CommandQueueBase>> m_queues;
+
+        template<Component T>
+        detail::CommandQueue<T>& queue() {
+            const auto id = type_id<T>();
+            if (id >= m_queues.size()) m_queues.resize(id + 1);
+            if (!m_queues[id]) m_queues[id] = std::make_unique<detail::CommandQueue<T>>();
+            return static_cast<detail::CommandQueue<T>&>(*m_queues[id]);
+        }
+
+        template<Component T>
+        detail::CommandQueue<T>* find_queue() {
+            const auto id = type_id<T>();
+            return (id < m_queues.size()) ? static_cast<detail::CommandQueue<T>*>(m_queues[id].get()) : nullptr;
+        }
+    };
+
+    namespace detail {
+        template<Component T>
+        class CommandQueue final : public CommandQueueBase {
+        public:
+            struct Command {
+                Entity entity;
+                bool insert;
+                T component;
+            };
+
+            inline void push(Command command) { m_commands.push_back(std::move(command)); }
+
+            bool empty() const override { return m_commands.empty(); }
+            void clear() override { m_commands.clear(); }
+
+            void apply(World& world, std::span<CommandBuffer* const> buffers) override {
+                // Gather into this queue so its capacity is reused from frame to frame
+                for (auto* buffer : buffers) {
+                    auto* other = buffer->find_queue<T>();
+                    if ((other == nullptr) || (other == this)) continue;
+                    std::move(other->m_commands.begin(), other->m_commands.end(), std::back_inserter(m_commands));
+                    other->clear();
+                }
+
+                std::stable_sort(m_commands.begin(), m_commands.end(), [](const Command& lhs, const Command& rhs) {
+                    return lhs.entity.id < rhs.entity.id;
+                });
+
+                auto& storage = world.write_component<T>();
+                if constexpr (requires { storage.reserve(size_t(0)); }) {
+                    // Like World::create_entities: VectorStorage reserves ids below the bound, not a count
+                    uint32_t max_id = 0;
+                    bool inserts = false;
+                    for (const auto& command : m_commands) {
+                        if (!command.insert) continue;
+                        max_id = std::max(max_id, command.entity.id);
+                        inserts = true;
+                    }
+                    if (inserts) storage.reserve(max_id + 1);
+                }
+
+                for (const auto& command : m_commands) {
+                    if (command.insert) {
+                        storage.insert(command.entity, command.component);
+                    } else if (storage.contains(command.entity)) {
+                        storage.remove(command.entity);
+                    }
+                }
+                clear();
+            }
+
+        private:
+            std::vector<Command> m_commands;
+        };
+    }
+
+}
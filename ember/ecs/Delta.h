@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "ChangeTick.h"
+#include "Component.h"
+#include "Entity.h"
+#include "EntitySet.h"
+#include "Snapshot.h"
+#include "World.h"
+
+namespace ember::ecs {
+
+    // Deltas replicate the components of a world to a replica, one message per tick,
+    // each holding only what changed since the previous one:
+    //
+    //      version byte, then per storage with changes:
+    //          stable type hash (8 bytes), varint byte size of the entries, entries
+    //      entry: varint id gap from the previous entry, varint (generation << 2 | op),
+    //          then for inserts and updates a bitset of the non-zero bytes of the
+    //          component XOR its previous value, followed by those bytes
+    //
+    // Updates that touch a few fields cost a few bytes and inserts skip zero bytes.
+    // Varints are little-endian base 128. Components are sent as raw memory, so both
+    // ends must share the byte order and the component layouts.
+    static constexpr uint8_t DELTA_VERSION = 1;
+
+    class DeltaWriter {
+    public:
+        explicit DeltaWriter(std::vector<std::byte>& out): m_out(&out) { }
+
+        inline void write_byte(uint8_t value) { m_out->push_back(std::byte(value)); }
+        void write_varint(uint64_t value);
+        void write_bytes(std::span<const std::byte> bytes);
+
+        inline size_t size() const { return m_out->size(); }
+
+    private:
+        std::vector<std::byte>* m_out;
+    };
+
+    class DeltaReader {
+    public:
+        explicit DeltaReader(std::span<const std::byte> data): m_data(data) { }
+
+        inline bool done() const { return m_offset >= m_data.size(); }
+
+        uint8_t read_byte();
+        uint64_t read_varint();
+        std::span<const std::byte> read_bytes(size_t size);
+
+    private:
+        std::span<const std::byte> m_data;
+        size_t m_offset = 0;
+    };
+
+    namespace detail {
+        enum class DeltaOp : uint8_t {
+            Insert,
+            Update,
+            Remove
+        };
+
+        // Last state sent or received for one component type, indexed by entity id
+        template<typename T>
+        struct DeltaBaseline {
+            EntitySet entities;
+            std::vector<T> values;
+
+            void set(Entity e, const T& value) {
+                if (e.id >= values.size()) {
+                    values.resize(e.id + 1);
+                    entities.resize(e.id + 1);
+                }
+                values[e.id] = value;
+                entities.insert(e);
+            }
+
+            void clear() {
+                for (uint32_t id = 0; id < values.size(); id++) entities.remove(Entity(0, id));
+                values.clear();
+            }
+        };
+
+        // XOR of value and previous as a bitset of the non-zero bytes and those bytes
+        template<typename T>
+        void write_xor(DeltaWriter& writer, const T& value, const T& previous) {
+            std::byte diff[sizeof(T)];
+            std::memcpy(diff, &value, sizeof(T));
+            const auto* prev = reinterpret_cast<const std::byte*>(&previous);
+            for (size_t i = 0; i < sizeof(T); i++) diff[i] ^= prev[i];
+
+            uint8_t mask[(sizeof(T) + 7) / 8] {};
+            for (size_t i = 0; i < sizeof(T); i++) {
+                if (diff[i] != std::byte(0)) mask[i / 8] |= uint8_t(1u << (i % 8));
+            }
+            for (const auto m : mask) writer.write_byte(m);
+            for (size_t i = 0; i < sizeof(T); i++) {
+                if (diff[i] != std::byte(0)) writer.write_byte(uint8_t(diff[i]));
+            }
+        }
+
+        template<typename T>
+        T read_xor(DeltaReader& reader, const T& previous) {
+            uint8_t mask[(sizeof(T) + 7) / 8];
+            for (auto& m : mask) m = reader.read_byte();
+
+            std::byte bytes[sizeof(T)];
+            std::memcpy(bytes, &previous, sizeof(T));
+            for (size_t i = 0; i < sizeof(T); i++) {
+                if (mask[i / 8] & (1u << (i % 8))) bytes[i] ^= std::byte(reader.read_byte());
+            }
+
+            T value;
+            std::memcpy(&value, bytes, sizeof(T));
+            return value;
+        }
+
+        class DeltaChannel {
+        public:
+            explicit DeltaChannel(uint64_t type_hash): type_hash(type_hash) { }
+            virtual ~DeltaChannel() = default;
+
+            const uint64_t type_hash;
+
+            // Write the entries of the changes since the baseline and make the current
+            // state the baseline. Components whose change tick is older than since are
+            // known to be unchanged and not compared.
+            virtual void encode(const World& world, Tick since, DeltaWriter& writer) = 0;
+            virtual void decode(World& world, DeltaReader& reader) = 0;
+            virtual void reset() = 0;
+        };
+
+        template<Component T>
+        class DeltaChannelImpl final : public DeltaChannel {
+        public:
+            DeltaChannelImpl(): DeltaChannel(stable_type_hash<T>()) { }
+
+            void encode(const World& world, Tick since, DeltaWriter& writer) override {
+                using S = typename T::Storage;
+                const auto& storage = world.read_component<T>();
+
+                m_changes.clear();
+                for (const auto e : storage.entities()) {
+                    if (!m_baseline.entities.contains(e)) {
+                        m_changes.push_back({ e, DeltaOp::Insert });
+                        continue;
+                    }
+                    if constexpr (TrackedStorage<S>) {
+                        // Changes at since itself are kept, they may follow the previous encode
+                        if (tick_newer_than(since, storage.ticks(e).changed)) continue;
+                    }
+                    const T value = storage[e];
+                    if (std::memcmp(&value, &m_baseline.values[e.id], sizeof(T)) != 0) {
+                        m_changes.push_back({ e, DeltaOp::Update });
+                    }
+                }
+                for (const auto e : m_baseline.entities) {
+                    if (!storage.contains(e)) m_changes.push_back({ e, DeltaOp::Remove });
+                }
+                // By id, a removed stale generation before the insert replacing it
+                std::sort(m_changes.begin(), m_changes.end(), [](const Change& lhs, const Change& rhs) {
+                    if (lhs.entity.id != rhs.entity.id) return lhs.entity.id < rhs.entity.id;
+                    return lhs.op > rhs.op;
+                });
+
+                uint32_t previous_id = 0;
+                for (const auto& [e, op] : m_changes) {
+                    writer.write_varint(e.id - previous_id);
+                    writer.write_varint((uint64_t(e.generation) << 2) | uint64_t(op));
+                    previous_id = e.id;
+
+                    if (op == DeltaOp::Remove) {
+                        m_baseline.entities.remove(e);
+                        continue;
+                    }
+                    const T value = storage[e];
+                    write_xor(writer, value, (op == DeltaOp::Insert) ? T {} : m_baseline.values[e.id]);
+                    m_baseline.set(e, value);
+                }
+            }
+
+            void decode(World& world, DeltaReader& reader) override {
+                if (!world.has_component<T>()) world.add_component<T>();
+                auto& storage = world.write_component<T>();
+
+                uint32_t id = 0;
+                while (!reader.done()) {
+                    id += uint32_t(reader.read_varint());
+                    const auto tag = reader.read_varint();
+                    const auto op = DeltaOp(tag & 3);
+                    const auto e = Entity(uint32_t(tag >> 2), id);
+
+                    if (op == DeltaOp::Remove) {
+                        if (!m_baseline.entities.contains(e)) throw std::runtime_error("Delta removes an unknown component!");
+                        m_baseline.entities.remove(e);
+                        if (storage.contains(e)) storage.remove(e);
+                        continue;
+                    }
+                    if ((op == DeltaOp::Update) && !m_baseline.entities.contains(e)) {
+                        throw std::runtime_error("Delta updates an unknown component!");
+                    }
+
+                    const auto value = read_xor(reader, (op == DeltaOp::Insert) ? T {} : m_baseline.values[e.id]);
+                    m_baseline.set(e, value);
+                    storage.insert(e, value);
+                }
+            }
+
+            void reset() override {
+                m_baseline.clear();
+            }
+
+        private:
+            struct Change {
+                Entity entity;
+                DeltaOp op;
+            };
+
+            DeltaBaseline<T> m_baseline;
+            std::vector<Change> m_changes;
+        };
+    }
+
+    // Encodes the registered components of a world as deltas against the state sent
+    // with the previous encode(). The first delta (and the first after reset()) holds
+    // the whole state. Components must be trivially copyable and are compared and
+    // sent as raw bytes.
+    class DeltaEncoder {
+    public:
+        template<Component T>
+        void add_component() {
+            static_assert(std::is_trivially_copyable_v<T>, "Deltas encode components as raw memory");
+            m_channels.push_back(std::make_unique<detail::DeltaChannelImpl<T>>());
+        }
+
+        // Append the delta to out. Storages without changes add nothing, so a tick
+        // without changes costs a single byte.
+        void encode(const World& world, std::vector<std::byte>& out);
+
+        // Forget the state sent so far, e.g. for a replica that lost sync
+        void reset();
+
+    private:
+        std::vector<std::unique_ptr<detail::DeltaChannel>> m_channels;
+        std::vector<std::byte> m_scratch;
+        // Change tick of the previous encode, 0 compares every component
+        Tick m_since = 0;
+    };
+
+    // Applies deltas to a replica in the order they were encoded. The replica mirrors
+    // the entity ids of the source so it should not create entities of its own.
+    // Storages the decoder does not know are skipped.
+    class DeltaDecoder {
+    public:
+        template<Component T>
+        void add_component() {
+            static_assert(std::is_trivially_copyable_v<T>, "Deltas encode components as raw memory");
+            m_channels.push_back(std::make_unique<detail::DeltaChannelImpl<T>>());
+        }
+
+        void apply(World& world, std::span<const std::byte> delta);
+
+        void reset();
+
+    private:
+        std::vector<std::unique_ptr<detail::DeltaChannel>> m_channels;
+    };
+
+}
@@ -18,8 +18,9 @@ namespace ember::ecs {
         constexpr Entity(const Entity&) = default;
         constexpr Entity(Entity&&) = default;
 
-        constexpr inline Entity& operator=(const Entity& rhs) { this->raw = rhs.raw; return *this; }
-        constexpr inline Entity& operator=(Entity&& rhs) { this->raw = rhs.raw; return *this; }
+        // Defaulted so entities stay trivially copyable and can be copied as raw memory
+        constexpr Entity& operator=(const Entity&) = default;
+        constexpr Entity& operator=(Entity&&) = default;
 
         friend constexpr inline std::strong_ordering operator<=>(const Entity& lhs, const Entity& rhs) {
             return lhs.id <=> rhs.id;
@@ -33,6 +34,12 @@ namespace ember::ecs {
         }
     };
 
+    // Whether e is a later generation than other, for two entities of the same id.
+    // Generations wrap around so they are compared through their signed difference.
+    constexpr bool newer_generation(Entity e, Entity other) {
+        return int32_t(e.generation - other.generation) > 0;
+    }
+
     static constexpr Entity WORLD_ORIGIN_ENTITY = Entity(0);
     static constexpr Entity INVALID_ENTITY = Entity(-1ULL);
 
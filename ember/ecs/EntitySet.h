@@ -1,9 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <concepts>
 #include <vector>
 
 #include "Entity.h"
+#include "Snapshot.h"
 #include "ember/collections/DynamicBitset.h"
 
 namespace ember::ecs {
@@ -22,7 +25,10 @@ namespace ember::ecs {
         }
 
         inline size_t size() const { return m_ids.size(); }
-        inline void resize(size_t size) { m_ids.resize(size); }
+        inline void resize(size_t size) {
+            m_ids.resize(size);
+            m_generations.resize(size);
+        }
 
         void insert(Entity e);
         void remove(Entity e);
@@ -32,7 +38,7 @@ namespace ember::ecs {
             using value_type = Entity;
             using difference_type = ptrdiff_t;
 
-            iterator() = default;
+            iterator(): id(0), ids(nullptr), generations(nullptr) { }
             iterator(uint32_t id, const collections::DynamicBitset* ids, const uint32_t* generations):
                 id(id), ids(ids), generations(generations)
             {
@@ -69,8 +75,19 @@ namespace ember::ecs {
             const collections::DynamicBitset* ids;
             const uint32_t* generations;
 
+            // Skip whole empty words so sparse sets iterate in O(words + entities)
             void find_valid_id() {
-                while (!ids->test(id) && id < ids->size()) id++;
+                const auto size = ids->size();
+                const auto& words = ids->data();
+                while (id < size) {
+                    const auto word = words[id >> 6] >> (id & 0x3f);
+                    if (word) {
+                        id += std::countr_zero(word);
+                        break;
+                    }
+                    id = (id | 0x3f) + 1;
+                }
+                if (id > size) id = size;
             }
         };
         static_assert(std::forward_iterator<iterator>);
@@ -78,12 +95,19 @@ namespace ember::ecs {
         inline iterator begin() const {
             return iterator(0, &m_ids, m_generations.data());
         }
+        // Iterator to the first entity with an id of at least id
+        inline iterator iter_from(uint32_t id) const {
+            return iterator(std::min<size_t>(id, m_generations.size()), &m_ids, m_generations.data());
+        }
         inline iterator end() const {
             return iterator(m_generations.size(), &m_ids, m_generations.data());\
         }
 
         std::vector<Entity> as_vec() const;
 
+        void write_snapshot(SnapshotWriter& writer) const;
+        void read_snapshot(SnapshotReader& reader);
+
         EntitySet& operator&=(const EntitySet& rhs);
         friend EntitySet operator&(const EntitySet& lhs, const EntitySet& rhs);
 
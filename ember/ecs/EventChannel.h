@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ember::ecs {
+
+    // Typed stream of events between systems. Any number of threads publish into the
+    // current buffer without locks: a slot is claimed with a single atomic increment and
+    // written in place. Readers see the events published before the last swap, so
+    // producers and consumers never touch the same buffer and neither needs to declare
+    // access to the channel. World::run swaps the buffers at the start of every phase,
+    // so events are read during the phase after the one publishing them and dropped
+    // after it. Events published in the last phase are read in the first phase of the
+    // next run.
+    //
+    // Slots are preallocated. Events past the capacity go to a lock-free overflow list
+    // and the capacity grows at the next swap to the busiest phase seen, so a steady
+    // state does not allocate. Events from different threads are not ordered.
+    template<typename E>
+        requires std::default_initializable<E> && std::copyable<E>
+    class EventChannel {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+        explicit EventChannel(size_t capacity = DEFAULT_CAPACITY) {
+            for (auto& buffer : m_buffers) buffer.events.resize(std::max<size_t>(capacity, 1));
+        }
+
+        ~EventChannel() {
+            for (auto& buffer : m_buffers) free_overflow(buffer.overflow.exchange(nullptr));
+        }
+
+        EventChannel(const EventChannel&) = delete;
+        EventChannel& operator=(const EventChannel&) = delete;
+
+        // Safe to call from any thread while the world runs
+        void publish(E event) {
+            auto& buffer = m_buffers[m_write];
+            const auto slot = buffer.published.fetch_add(1, std::memory_order_relaxed);
+            if (slot < buffer.events.size()) {
+                buffer.events[slot] = std::move(event);
+                return;
+            }
+
+            auto* node = new OverflowNode { std::move(event), buffer.overflow.load(std::memory_order_relaxed) };
+            while (!buffer.overflow.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) { }
+        }
+
+        // Events published before the last swap
+        inline std::span<const E> read() const {
+            const auto& buffer = m_buffers[m_write ^ 1];
+            return std::span<const E>(buffer.events.data(), buffer.readable);
+        }
+
+        // Number of events a phase can publish before overflowing
+        inline size_t capacity() const { return m_buffers[m_write].events.size(); }
+
+        // Make the events published so far readable and drop the ones read until now.
+        // Must not run concurrently with publish() or read().
+        void swap() {
+            auto& published = m_buffers[m_write];
+            const auto count = published.published.exchange(0, std::memory_order_relaxed);
+            const auto stored = std::min(count, published.events.size());
+
+            // Overflowed events are appended so the buffer ends up large enough for
+            // these events, and the other buffer grows to match below
+            auto* overflow = published.overflow.exchange(nullptr, std::memory_order_acquire);
+            if (overflow != nullptr) {
+                published.events.resize(count);
+                auto index = count;
+                for (auto* node = overflow; node != nullptr; node = node->next) {
+                    published.events[--index] = node->event;
+                }
+                free_overflow(overflow);
+            }
+            published.readable = overflow ? count : stored;
+
+            m_write ^= 1;
+            auto& next = m_buffers[m_write];
+            next.readable = 0;
+            if (next.events.size() < published.events.size()) next.events.resize(published.events.size());
+        }
+
+    private:
+        struct OverflowNode {
+            E event;
+            OverflowNode* next;
+        };
+
+        struct Buffer {
+            std::vector<E> events;
+            std::atomic<size_t> published = 0;
+            std::atomic<OverflowNode*> overflow = nullptr;
+            // Events visible to readers while this is the read buffer
+            size_t readable = 0;
+        };
+
+        Buffer m_buffers[2];
+        size_t m_write = 0;
+
+        static void free_overflow(OverflowNode* node) {
+            while (node != nullptr) {
+                auto* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+    };
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include "Component.h"
+#include "Storage.h"
+
+namespace ember::ecs {
+
+    // World space transform of an entity, the product of the TransformComponent of
+    // the entity and of all of its ancestors. Written by TransformPropagationSystem.
+    struct GlobalTransformComponent {
+        using Storage = VectorStorage<GlobalTransformComponent>;
+        glm::mat4 transform = glm::identity<glm::mat4>();
+    };
+    static_assert(Component<GlobalTransformComponent>);
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "Entity.h"
+#include "StorageHooks.h"
+
+namespace ember::ecs {
+
+    class World;
+
+    enum class ComponentEvent : uint8_t {
+        Inserted,
+        Replaced,
+        Removed
+    };
+
+    struct ComponentChange {
+        Entity entity;
+        ComponentEvent event;
+    };
+
+    using ObserverFn = std::function<void(World&, std::span<const ComponentChange>)>;
+
+    // Queues the structural changes of one storage until deliver() hands the whole
+    // batch to the callback, in the order they happened. Usually created through
+    // World::observe() which delivers at every phase barrier.
+    //
+    // By the time a batch is delivered removed components are gone and an inserted
+    // entity may have been removed again, so callbacks check the storage when they
+    // need the component itself. Changes made by the callback are queued for the next
+    // batch.
+    class ComponentObserver {
+    public:
+        ComponentObserver(StorageHooks& hooks, ObserverFn fn): m_storage_hooks(&hooks), m_fn(std::move(fn)) {
+            m_hooks[0] = hooks.on_insert([this](Entity e) { m_changes.push_back({ e, ComponentEvent::Inserted }); });
+            m_hooks[1] = hooks.on_replace([this](Entity e) { m_changes.push_back({ e, ComponentEvent::Replaced }); });
+            m_hooks[2] = hooks.on_remove([this](Entity e) { m_changes.push_back({ e, ComponentEvent::Removed }); });
+        }
+
+        ~ComponentObserver() {
+            for (const auto id : m_hooks) m_storage_hooks->remove_hook(id);
+        }
+
+        ComponentObserver(const ComponentObserver&) = delete;
+        ComponentObserver& operator=(const ComponentObserver&) = delete;
+
+        inline bool pending() const { return !m_changes.empty(); }
+
+        // Both queues keep their capacity, so steady traffic stops allocating
+        void deliver(World& world) {
+            if (m_changes.empty()) return;
+            std::swap(m_changes, m_delivering);
+            m_fn(world, m_delivering);
+            m_delivering.clear();
+        }
+
+    private:
+        StorageHooks* m_storage_hooks;
+        std::array<StorageHooks::HookId, 3> m_hooks;
+        ObserverFn m_fn;
+        std::vector<ComponentChange> m_changes;
+        std::vector<ComponentChange> m_delivering;
+    };
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "View.h"
+#include "ember/util/ThreadPool.h"
+
+namespace ember::ecs {
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr size_t DEFAULT_PARALLEL_GRAIN = 1024;
+
+    // Smallest number of elements of T spanning a whole number of cache lines
+    template<typename T>
+    constexpr size_t cache_line_elements() {
+        return CACHE_LINE_SIZE / std::gcd(sizeof(T), CACHE_LINE_SIZE);
+    }
+
+    // Split [0, count) into chunks whose boundaries (after the first) fall on multiples of
+    // grain starting at first_boundary, and call fn(begin, end) for each chunk on the pool.
+    // Runs inline without a pool or when everything fits in a single chunk.
+    template<typename Fn>
+    void parallel_for(util::ThreadPool* pool, size_t count, size_t grain, Fn&& fn, size_t first_boundary = 0) {
+        grain = std::max<size_t>(grain, 1);
+        if ((pool == nullptr) || (count <= grain)) {
+            if (count) fn(size_t(0), count);
+            return;
+        }
+
+        util::TaskGroup group(pool);
+        size_t begin = 0;
+        size_t end = std::min(count, first_boundary + grain);
+        while (begin < count) {
+            group.run([&fn, begin, end]() { fn(begin, end); });
+            begin = end;
+            end = std::min(count, end + grain);
+        }
+        group.wait();
+    }
+
+    namespace detail {
+        // Index of the first element of a contiguous range that starts a cache line, so
+        // that no cache line is shared (and falsely shared) between two chunks.
+        template<typename Iter>
+        size_t first_cache_line_boundary(Iter first) {
+            using T = std::iter_value_t<Iter>;
+            if constexpr (std::contiguous_iterator<Iter>) {
+                const auto address = reinterpret_cast<uintptr_t>(std::to_address(first));
+                for (size_t i = 0; i < cache_line_elements<T>(); i++) {
+                    if (((address + i * sizeof(T)) % CACHE_LINE_SIZE) == 0) return i;
+                }
+            }
+            return 0;
+        }
+
+        template<typename T>
+        size_t align_grain(size_t grain) {
+            const auto line = cache_line_elements<T>();
+            return std::max(line, ((grain + line - 1) / line) * line);
+        }
+    }
+
+    // Call fn(Component&) for every component of a storage with random access iterators,
+    // splitting the dense array into cache line aligned chunks of about grain elements.
+    template<typename S, typename Fn>
+        requires std::random_access_iterator<decltype(std::declval<S&>().begin())>
+    void parallel_for_each(util::ThreadPool* pool, S& storage, Fn&& fn, size_t grain = DEFAULT_PARALLEL_GRAIN) {
+        using T = std::iter_value_t<decltype(storage.begin())>;
+
+        const auto first = storage.begin();
+        const auto count = size_t(storage.end() - first);
+        parallel_for(
+            pool,
+            count,
+            detail::align_grain<T>(grain),
+            [&](size_t begin, size_t end) {
+                for (auto i = begin; i < end; i++) fn(first[i]);
+            },
+            detail::first_cache_line_boundary(first)
+        );
+    }
+
+    // Call fn(Entity, T&...) for every entity of the view, splitting the range of the
+    // storage that drives the view into chunks of about grain entities.
+    // The view writes the components of its mutable terms, so it is taken as non-const.
+    template<typename... T, typename Fn>
+    void parallel_for_each(util::ThreadPool* pool, View<T...>& view, Fn&& fn, size_t grain = DEFAULT_PARALLEL_GRAIN) {
+        // Stamped up front so the chunks only read the stamps of the storages
+        view.touch();
+        parallel_for(pool, view.extent(), grain, [&](size_t begin, size_t end) {
+            view.each_in(begin, end, fn);
+        });
+    }
+
+    template<typename... T, typename Fn>
+    void parallel_for_each(util::ThreadPool* pool, View<T...>&& view, Fn&& fn, size_t grain = DEFAULT_PARALLEL_GRAIN) {
+        parallel_for_each(pool, view, std::forward<Fn>(fn), grain);
+    }
+
+    // One slot per pool thread (plus one for the thread that waits on the pool) so tasks
+    // can accumulate without atomics or sharing cache lines, then combine at the end.
+    template<typename T>
+    class Reduction {
+    public:
+        Reduction(util::ThreadPool* pool, const T& identity = T()):
+            m_pool(pool), m_slots(pool ? pool->worker_count() + 1 : 1, Slot { identity })
+        { }
+
+        T& local() {
+            const auto worker = m_pool ? m_pool->worker_index() : util::ThreadPool::NOT_A_WORKER;
+            return m_slots[(worker == util::ThreadPool::NOT_A_WORKER) ? 0 : worker + 1].value;
+        }
+
+        template<typename Op>
+        T combine(const T& init, Op op) const {
+            auto result = init;
+            for (const auto& slot : m_slots) result = op(result, slot.value);
+            return result;
+        }
+
+    private:
+        struct alignas(CACHE_LINE_SIZE) Slot {
+            T value;
+        };
+
+        util::ThreadPool* m_pool;
+        std::vector<Slot> m_slots;
+    };
+
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Component.h"
+#include "Entity.h"
+#include "Storage.h"
+
+namespace ember::ecs {
+
+    // Places the TransformComponent of an entity in the space of its parent, see
+    // TransformPropagationSystem. Entities without a parent are roots.
+    struct ParentComponent {
+        using Storage = SparseSetStorage<ParentComponent>;
+        Entity parent = WORLD_ORIGIN_ENTITY;
+    };
+    static_assert(Component<ParentComponent>);
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Snapshot.h"
+#include "World.h"
+
+namespace ember::ecs {
+
+    // Ring of the last few in-memory snapshots of a world, for rollback netcode or
+    // rewinding: save() every frame, restore() a frame when a late input arrives and
+    // simulate forward again. Slots keep their buffers, so once the ring is warm a save
+    // is a memcpy of each storage's arrays without any allocation. Restoring only
+    // reloads the storages modified since the snapshot, found from their change ticks.
+    //
+    // Frames are any increasing numbers chosen by the caller, e.g. the world's run count.
+    class RollbackBuffer {
+    public:
+        explicit RollbackBuffer(size_t capacity);
+
+        // Snapshot world as frame, overwriting the oldest snapshot once full. Frames
+        // must increase, saving a frame again replaces it and every later one. The
+        // change tick of the world moves forward so that later changes are newer than
+        // the snapshot.
+        void save(World& world, uint64_t frame);
+
+        bool contains(uint64_t frame) const;
+
+        // Put the world back to frame and drop the snapshots after it, which the
+        // simulation is about to replace
+        void restore(World& world, uint64_t frame);
+
+        // Frames of the oldest and latest snapshots, only valid when not empty
+        uint64_t oldest() const;
+        uint64_t latest() const;
+
+        inline size_t size() const { return m_size; }
+        inline size_t capacity() const { return m_slots.size(); }
+        inline bool empty() const { return m_size == 0; }
+
+        void clear();
+
+    private:
+        struct Slot {
+            uint64_t frame = 0;
+            SnapshotBuffer data;
+        };
+
+        std::vector<Slot> m_slots;
+        // Slot of the oldest snapshot, the others follow it around the ring
+        size_t m_first = 0;
+        size_t m_size = 0;
+
+        inline Slot& slot(size_t index) { return m_slots[(m_first + index) % m_slots.size()]; }
+        inline const Slot& slot(size_t index) const { return m_slots[(m_first + index) % m_slots.size()]; }
+        // Number of snapshots with a frame before frame
+        size_t count_before(uint64_t frame) const;
+    };
+
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <stdexcept>
+
+namespace ember::ecs {
+
+    // How often World::run runs a system. Declared by a system as e.g.
+    //      static constexpr ecs::RunPolicy RUN_POLICY = ecs::RunPolicy::fixed_rate(10.0f);
+    // or set on a world with World::set_run_policy(). A system that is skipped keeps
+    // its last run tick, so change filters see everything since it last ran, and is
+    // passed the time elapsed since then as dt.
+    struct RunPolicy {
+        enum class Kind : uint8_t {
+            Always,
+            EveryNFrames,
+            FixedRate,
+            TimeBudget
+        };
+
+        Kind kind = Kind::Always;
+        uint32_t frames = 1;
+        uint32_t offset = 0;
+        float interval = 0.0f;
+        std::chrono::microseconds budget { 0 };
+
+        static constexpr RunPolicy always() { return RunPolicy(); }
+
+        // Run on every nth run of the world. Systems with the same n but different
+        // offsets run on different frames, which spreads their cost.
+        static constexpr RunPolicy every_n_frames(uint32_t n, uint32_t offset = 0) {
+            if (n == 0) throw std::invalid_argument("RunPolicy requires at least one frame");
+            return RunPolicy { .kind = Kind::EveryNFrames, .frames = n, .offset = offset % n };
+        }
+
+        // Run at most once per world run, on the first run after each interval of
+        // 1/hz seconds. Intervals missed in between are dropped, not caught up on.
+        static constexpr RunPolicy fixed_rate(float hz) {
+            if (!(hz > 0.0f)) throw std::invalid_argument("RunPolicy requires a positive rate");
+            return RunPolicy { .kind = Kind::FixedRate, .interval = 1.0f / hz };
+        }
+
+        // Run every frame but stop processing the TimeSlice once the budget is spent,
+        // resuming where it stopped on the next run
+        static constexpr RunPolicy time_budget(std::chrono::microseconds budget) {
+            return RunPolicy { .kind = Kind::TimeBudget, .budget = budget };
+        }
+    };
+
+    template<typename S>
+    constexpr RunPolicy system_run_policy() {
+        if constexpr (requires { { S::RUN_POLICY } -> std::convertible_to<RunPolicy>; }) return S::RUN_POLICY;
+        else return RunPolicy();
+    }
+
+    // Resumable walk over a range of work items, obtained from World::time_slice()
+    // inside a system. Under a time budget it stops once the budget is spent and the
+    // next run continues from there; without one it covers the whole range. The
+    // cursor is a plain index so the range must keep a stable order between runs
+    // (e.g. the entities of a cached query); a range that shrank below the cursor
+    // starts over.
+    class TimeSlice {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t DEFAULT_CHECK_INTERVAL = 32;
+
+        // Call fn(i) for the items from the cursor on, reading the clock every
+        // check_interval items. Returns true once the end of the range was reached, the
+        // cursor then goes back to the start for the next run.
+        template<typename F>
+        bool run(size_t count, F&& fn, size_t check_interval = DEFAULT_CHECK_INTERVAL) {
+            check_interval = std::max<size_t>(check_interval, 1);
+            if (m_cursor >= count) m_cursor = 0;
+
+            while (m_cursor < count) {
+                const auto end = std::min(count, m_cursor + check_interval);
+                for (; m_cursor < end; m_cursor++) fn(m_cursor);
+                if ((m_cursor < count) && expired()) return false;
+            }
+            m_cursor = 0;
+            return true;
+        }
+
+        inline size_t cursor() const { return m_cursor; }
+        inline bool expired() const { return (m_deadline != Clock::time_point::max()) && (Clock::now() >= m_deadline); }
+
+        inline void set_deadline(Clock::time_point deadline) { m_deadline = deadline; }
+
+    private:
+        size_t m_cursor = 0;
+        Clock::time_point m_deadline = Clock::time_point::max();
+    };
+
+    // Run state of one system under its policy, kept by the world
+    class RunSchedule {
+    public:
+        RunSchedule() = default;
+        explicit RunSchedule(RunPolicy policy): m_policy(policy) { }
+
+        inline const RunPolicy& policy() const { return m_policy; }
+        inline void set_policy(RunPolicy policy) {
+            m_policy = policy;
+            m_accumulator = 0.0f;
+        }
+
+        // Account for a run of the world taking dt, returning whether the system is
+        // due. When it is, dt() is the time elapsed since the system last ran.
+        bool advance(float dt, uint64_t frame) {
+            m_elapsed += dt;
+
+            auto due = true;
+            switch (m_policy.kind) {
+                case RunPolicy::Kind::EveryNFrames:
+                    due = (frame % m_policy.frames) == m_policy.offset;
+                    break;
+                case RunPolicy::Kind::FixedRate:
+                    m_accumulator += dt;
+                    due = m_accumulator >= m_policy.interval;
+                    if (due) {
+                        m_accumulator -= m_policy.interval;
+                        // Fell behind by more than an interval, start over from now
+                        if (m_accumulator >= m_policy.interval) m_accumulator = 0.0f;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            if (!due) return false;
+
+            m_dt = m_elapsed;
+            m_elapsed = 0.0f;
+            return true;
+        }
+
+        inline float dt() const { return m_dt; }
+
+        // Slice for the run starting now
+        TimeSlice& begin_slice() {
+            if (m_policy.kind == RunPolicy::Kind::TimeBudget) {
+                m_slice.set_deadline(TimeSlice::Clock::now() + m_policy.budget);
+            } else {
+                m_slice.set_deadline(TimeSlice::Clock::time_point::max());
+            }
+            return m_slice;
+        }
+
+    private:
+        RunPolicy m_policy;
+        float m_elapsed = 0.0f;
+        float m_accumulator = 0.0f;
+        float m_dt = 0.0f;
+        TimeSlice m_slice;
+    };
+
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ember::ecs {
+
+    // Binary snapshots are a sequence of blocks, each starting on a SNAPSHOT_ALIGNMENT
+    // boundary of the file with its byte size followed (on the next boundary) by the
+    // raw data. A snapshot mapped in memory can then be read in place, storages just
+    // copy whole blocks into their arrays without parsing individual entities.
+    //
+    //      header block, free entity block, then per storage:
+    //          record block { stable type hash, byte size of the storage blocks }
+    //          storage blocks
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+    static constexpr size_t SNAPSHOT_ALIGNMENT = 64;
+
+    struct SnapshotHeader {
+        std::array<char, 4> magic { 'E', 'M', 'B', 'S' };
+        uint32_t version = SNAPSHOT_VERSION;
+        // Read back as anything else on a machine of different endianness
+        uint32_t byte_order = 0x01020304;
+        uint32_t tick = 0;
+        uint64_t next_entity = 0;
+    };
+
+    struct SnapshotRecord {
+        uint64_t type_hash = 0;
+        uint64_t size = 0;
+    };
+
+    namespace detail {
+        // Type whose layout a snapshot of T depends on: the component for storages
+        template<typename T>
+        struct SnapshotLayout { using type = T; };
+
+        template<typename T> requires requires { typename T::Component; }
+        struct SnapshotLayout<T> { using type = typename T::Component; };
+    }
+
+    // Hash of the name of T, which unlike TypeId does not depend on the order types
+    // are first used in so it identifies storages across runs. Only stable between
+    // builds of the same compiler as the name comes from __PRETTY_FUNCTION__. The size
+    // and alignment of T (of the component for storages) are folded in so a component
+    // whose layout changed between builds does not match older data.
+    template<typename T>
+    constexpr uint64_t stable_type_hash() {
+#ifdef _MSC_VER
+        constexpr std::string_view name = __FUNCSIG__;
+#else
+        constexpr std::string_view name = __PRETTY_FUNCTION__;
+#endif
+        using Layout = typename detail::SnapshotLayout<T>::type;
+
+        uint64_t hash = 14695981039346656037ULL;
+        const auto fold = [&hash](uint64_t value) {
+            hash ^= value;
+            hash *= 1099511628211ULL;
+        };
+        for (const auto c : name) fold(uint8_t(c));
+        fold(sizeof(Layout));
+        fold(alignof(Layout));
+        return hash;
+    }
+
+    // Allocates on SNAPSHOT_ALIGNMENT boundaries so a snapshot in memory can be read
+    // in place like a mapped file
+    template<typename T>
+    struct SnapshotAllocator {
+        using value_type = T;
+
+        SnapshotAllocator() = default;
+        template<typename U>
+        SnapshotAllocator(const SnapshotAllocator<U>&) { }
+
+        T* allocate(size_t count) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(SNAPSHOT_ALIGNMENT)));
+        }
+        void deallocate(T* data, size_t) {
+            ::operator delete(data, std::align_val_t(SNAPSHOT_ALIGNMENT));
+        }
+
+        // Default rather than value initialize, so growing a buffer about to be
+        // overwritten does not zero it first
+        template<typename U, typename... Args>
+        void construct(U* p, Args&&... args) {
+            if constexpr (sizeof...(Args) == 0) ::new(static_cast<void*>(p)) U;
+            else ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        bool operator==(const SnapshotAllocator<U>&) const { return true; }
+    };
+
+    using SnapshotBuffer = std::vector<std::byte, SnapshotAllocator<std::byte>>;
+
+    // Blocks are aligned relative to where the writer starts so it should start at
+    // the beginning of a file or of an empty buffer. A stream must be seekable.
+    class SnapshotWriter {
+    public:
+        explicit SnapshotWriter(std::ostream& out): m_out(&out), m_start(out.tellp()) { }
+        // Appends to out, which keeps its capacity across snapshots when reused
+        explicit SnapshotWriter(SnapshotBuffer& out): m_buffer(&out), m_buffer_start(out.size()) { }
+
+        template<typename T>
+        void write_block(std::span<const T> data) {
+            static_assert(std::is_trivially_copyable_v<T>, "Snapshot blocks are raw memory");
+            write_block(data.data(), data.size_bytes());
+        }
+
+        template<typename T>
+        void write_value(const T& value) {
+            write_block(std::span<const T>(&value, 1));
+        }
+
+        // Storage blocks written between begin_record() and end_record() are skipped as
+        // a whole by readers that do not know the type
+        size_t begin_record(uint64_t type_hash);
+        void end_record(size_t record);
+
+    private:
+        std::ostream* m_out = nullptr;
+        std::streampos m_start;
+        SnapshotBuffer* m_buffer = nullptr;
+        size_t m_buffer_start = 0;
+        size_t m_offset = 0;
+
+        void write_block(const void* data, size_t size);
+        void write_raw(const void* data, size_t size);
+        void pad();
+    };
+
+    class SnapshotReader {
+    public:
+        // data must start on a SNAPSHOT_ALIGNMENT boundary, as a mapped file does
+        explicit SnapshotReader(std::span<const std::byte> data);
+
+        inline bool done() const { return m_offset >= m_data.size(); }
+        // Everything the reader covers, read or not
+        inline std::span<const std::byte> data() const { return m_data; }
+
+        // View of the next block in place, valid as long as the snapshot data
+        template<typename T>
+        std::span<const T> read_block() {
+            static_assert(std::is_trivially_copyable_v<T>, "Snapshot blocks are raw memory");
+            static_assert(alignof(T) <= SNAPSHOT_ALIGNMENT);
+
+            const auto bytes = read_block();
+            if (bytes.size() % sizeof(T) != 0) throw std::runtime_error("Snapshot block has an invalid size!");
+            return { reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T) };
+        }
+
+        template<typename T>
+        T read_value() {
+            const auto block = read_block<T>();
+            if (block.size() != 1) throw std::runtime_error("Snapshot block has an invalid size!");
+            return block[0];
+        }
+
+        template<typename T>
+        void read_into(std::vector<T>& out) {
+            const auto block = read_block<T>();
+            out.assign(block.begin(), block.end());
+        }
+
+        // Reader over the next size bytes, which this reader skips
+        SnapshotReader sub_reader(size_t size);
+
+    private:
+        std::span<const std::byte> m_data;
+        size_t m_offset = 0;
+
+        std::span<const std::byte> read_block();
+    };
+
+    // Storages that can write their contents as snapshot blocks and replace their
+    // contents with the blocks they wrote
+    template<typename S>
+    concept SnapshotStorage = requires(const S const_s, S s, SnapshotWriter& writer, SnapshotReader& reader) {
+        const_s.write_snapshot(writer);
+        s.read_snapshot(reader);
+    };
+
+}
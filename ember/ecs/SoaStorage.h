@@ -0,0 +1,404 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ChangeTick.h"
+#include "Entity.h"
+#include "EntitySet.h"
+#include "Snapshot.h"
+#include "Storage.h"
+#include "StorageHooks.h"
+
+namespace ember::ecs {
+
+    // Field list of a component kept as a structure of arrays. Specialized with
+    // EMBER_SOA_COMPONENT, which provides:
+    //  - FIELDS: tuple of pointers to the members stored in their own array
+    //  - Proxy<CONST>: struct of references named after the members, so storage[e].position
+    //    reads the same as with an array of structs
+    template<typename T>
+    struct SoaLayout;
+
+    namespace detail {
+        template<typename M>
+        struct SoaMember;
+
+        template<typename C, typename F>
+        struct SoaMember<F C::*> {
+            using Field = F;
+        };
+
+        template<typename Fields>
+        struct SoaArrays;
+
+        template<typename... M>
+        struct SoaArrays<std::tuple<M...>> {
+            using type = std::tuple<std::vector<typename SoaMember<M>::Field>...>;
+        };
+
+        template<typename Fields>
+        struct SoaFieldBytes;
+
+        template<typename... M>
+        struct SoaFieldBytes<std::tuple<M...>> {
+            static constexpr size_t value = (size_t(0) + ... + sizeof(typename SoaMember<M>::Field));
+        };
+    }
+
+    // Sparse set storage that splits a component into one packed array per field.
+    // Systems that touch a few fields of every component (integrators) stream just those
+    // arrays through the cache, and field() exposes them as spans for vectorized loops.
+    // Single components are accessed through proxies of references.
+    //
+    // Every field must be listed in the layout as fields left out would not be stored.
+    // This is checked by requiring the listed fields to add up to the size of the
+    // component, so components kept as a structure of arrays cannot have padding.
+    template<typename T>
+    class SoaStorage {
+    public:
+        using Component = T;
+        using Layout = SoaLayout<T>;
+        using reference = typename Layout::template Proxy<false>;
+        using const_reference = typename Layout::template Proxy<true>;
+
+        template<bool Const>
+        class Iterator {
+        public:
+            using value_type = T;
+            using difference_type = ptrdiff_t;
+            using reference = std::conditional_t<Const, SoaStorage::const_reference, SoaStorage::reference>;
+            using Storage = std::conditional_t<Const, const SoaStorage, SoaStorage>;
+
+            Iterator() = default;
+            Iterator(Storage* storage, size_t index): m_storage(storage), m_index(index) { }
+
+            reference operator*() const { return m_storage->proxy(m_index, FIELD_INDICES); }
+
+            Iterator& operator++() {
+                m_index++;
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            bool operator==(const Iterator& rhs) const { return m_index == rhs.m_index; }
+            bool operator!=(const Iterator& rhs) const { return m_index != rhs.m_index; }
+
+        private:
+            Storage* m_storage = nullptr;
+            size_t m_index = 0;
+        };
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        inline bool contains(Entity e) const {
+            return (e.id < m_sparse.size())
+                && (m_sparse[e.id] != NO_INDEX)
+                && (m_entities[m_sparse[e.id]].generation == e.generation);
+        }
+        inline const EntitySet& entities() const { return m_valid; }
+
+        void insert(Entity e, const Component& c) {
+            if (e.id >= m_sparse.size()) m_sparse.resize(e.id+1, NO_INDEX);
+
+            const auto index = m_sparse[e.id];
+            // Same id with a stale generation is replaced in place, while dead handles
+            // of an older generation are ignored rather than overwriting the live entity
+            const auto stale = (index != NO_INDEX) && (m_entities[index].generation != e.generation);
+            if (stale && !newer_generation(e, m_entities[index])) return;
+
+            const auto tick = touch();
+            if (index != NO_INDEX) {
+                if (stale) {
+                    m_hooks.removing(m_entities[index]);
+                    m_ticks[index].added = tick;
+                }
+                m_ticks[index].changed = tick;
+                m_entities[index] = e;
+                proxy(index, FIELD_INDICES) = c;
+                m_valid.insert(e);
+                if (stale) m_hooks.inserted(e);
+                else m_hooks.replaced(e);
+            } else {
+                m_sparse[e.id] = uint32_t(m_entities.size());
+                m_entities.push_back(e);
+                push_back(c, FIELD_INDICES);
+                m_ticks.push_back({ tick, tick });
+                m_valid.insert(e);
+                m_hooks.inserted(e);
+            }
+        }
+
+        void remove(Entity e) {
+            if (!contains(e)) throw std::out_of_range("Attempted to remove invalid component!");
+            m_hooks.removing(e);
+            touch();
+
+            const auto index = m_sparse[e.id];
+            const auto last = m_entities.size() - 1;
+            if (index != last) {
+                move_field_values(last, index, FIELD_INDICES);
+                m_entities[index] = m_entities[last];
+                m_ticks[index] = m_ticks[last];
+                m_sparse[m_entities[index].id] = index;
+            }
+            pop_back(FIELD_INDICES);
+            m_entities.pop_back();
+            m_ticks.pop_back();
+            m_sparse[e.id] = NO_INDEX;
+            m_valid.remove(e);
+        }
+
+        void remove_range(std::span<const Entity> entities) {
+            for (const auto e : entities) {
+                if (contains(e)) remove(e);
+            }
+        }
+
+        const_reference operator[](Entity e) const {
+            return proxy(m_sparse[e.id], FIELD_INDICES);
+        }
+        reference operator[](Entity e) {
+            const auto index = m_sparse[e.id];
+            m_ticks[index].changed = touch();
+            return proxy(index, FIELD_INDICES);
+        }
+
+        const_reference at(Entity e) const {
+            if (!contains(e)) throw std::out_of_range("Attempted to access invalid component!");
+            return (*this)[e];
+        }
+        reference at(Entity e) {
+            if (!contains(e)) throw std::out_of_range("Attempted to access invalid component!");
+            return (*this)[e];
+        }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        // Mutable iteration may touch any component so it marks all of them changed
+        iterator begin() {
+            mark_all_changed();
+            return iterator(this, 0);
+        }
+
+        const_iterator end() const { return const_iterator(this, m_entities.size()); }
+        iterator end() { return iterator(this, m_entities.size()); }
+
+        inline size_t size() const { return m_entities.size(); }
+        void reserve(size_t count) {
+            m_entities.reserve(count);
+            m_ticks.reserve(count);
+            std::apply([count](auto&... arrays) { (arrays.reserve(count), ...); }, m_fields);
+        }
+
+        // Packed array of one field, index i of which belongs to packed_entities()[i]
+        template<auto Member>
+        std::span<const typename detail::SoaMember<decltype(Member)>::Field> field() const {
+            return std::get<field_index<Member>()>(m_fields);
+        }
+        template<auto Member>
+        std::span<typename detail::SoaMember<decltype(Member)>::Field> field() {
+            mark_all_changed();
+            return std::get<field_index<Member>()>(m_fields);
+        }
+
+        // Writable arrays of several fields at once, marking the components changed
+        // only once. Read-only fields are better taken from the const storage.
+        template<auto... Members>
+        std::tuple<std::span<typename detail::SoaMember<decltype(Members)>::Field>...> fields() {
+            mark_all_changed();
+            return { std::get<field_index<Members>()>(m_fields)... };
+        }
+
+        inline std::span<const Entity> packed_entities() const { return m_entities; }
+        inline std::span<const ComponentTicks> packed_ticks() const { return m_ticks; }
+
+        inline const ComponentTicks& ticks(Entity e) const { return m_ticks[m_sparse[e.id]]; }
+        inline void bind_ticks(const Tick& tick) { m_tick = &tick; }
+        // Last tick any component was inserted, removed or mutably accessed
+        inline Tick modified_tick() const { return m_modified; }
+        // Stamp the storage modified at the current tick, see ModifiedStorage
+        Tick touch() {
+            const auto tick = now();
+            if (m_modified != tick) m_modified = tick;
+            return tick;
+        }
+        // Stamp every component changed at the current tick
+        void mark_all_changed() {
+            const auto tick = touch();
+            for (auto& ticks : m_ticks) ticks.changed = tick;
+        }
+        inline StorageHooks& hooks() { return m_hooks; }
+
+        void write_snapshot(SnapshotWriter& writer) const requires std::is_trivially_copyable_v<T> {
+            writer.write_block(std::span<const uint32_t>(m_sparse));
+            writer.write_block(std::span<const Entity>(m_entities));
+            std::apply([&writer](const auto&... arrays) { (writer.write_block(std::span(arrays)), ...); }, m_fields);
+            writer.write_block(std::span<const ComponentTicks>(m_ticks));
+            m_valid.write_snapshot(writer);
+        }
+
+        // Replaces the contents, running remove hooks for the old entities and insert
+        // hooks for the new ones
+        void read_snapshot(SnapshotReader& reader) requires std::is_trivially_copyable_v<T> {
+            if (!m_hooks.empty()) for (const auto e : m_entities) m_hooks.removing(e);
+            touch();
+
+            reader.read_into(m_sparse);
+            reader.read_into(m_entities);
+            std::apply([&reader](auto&... arrays) { (reader.read_into(arrays), ...); }, m_fields);
+            reader.read_into(m_ticks);
+            m_valid.read_snapshot(reader);
+            const auto count = m_entities.size();
+            const auto sized = std::apply([count](const auto&... arrays) { return ((arrays.size() == count) && ...); }, m_fields);
+            if (!sized || (m_ticks.size() != count)) {
+                throw std::runtime_error("Snapshot storage has an invalid size!");
+            }
+            detail::check_sparse_snapshot(m_sparse, m_entities);
+
+            if (!m_hooks.empty()) for (const auto e : m_entities) m_hooks.inserted(e);
+        }
+
+    private:
+        static constexpr uint32_t NO_INDEX = ~uint32_t(0);
+
+        using Fields = std::remove_const_t<decltype(Layout::FIELDS)>;
+        static constexpr auto FIELD_COUNT = std::tuple_size_v<Fields>;
+        static constexpr auto FIELD_INDICES = std::make_index_sequence<FIELD_COUNT>();
+        static_assert(
+            detail::SoaFieldBytes<Fields>::value == sizeof(T),
+            "The SoA layout must list every field of the component, which must not have padding"
+        );
+
+        std::vector<uint32_t> m_sparse;
+        std::vector<Entity> m_entities;
+        typename detail::SoaArrays<Fields>::type m_fields;
+        std::vector<ComponentTicks> m_ticks;
+        EntitySet m_valid;
+        StorageHooks m_hooks;
+
+        // Unbound storages stamp every change with tick 0
+        const Tick* m_tick = nullptr;
+
+        // Tick of the last change to any component, see modified_tick()
+        Tick m_modified = 0;
+
+        inline Tick now() const { return m_tick ? *m_tick : 0; }
+
+        template<size_t I, auto Member>
+        static constexpr bool is_field() {
+            if constexpr (std::is_same_v<std::tuple_element_t<I, Fields>, decltype(Member)>) {
+                return std::get<I>(Layout::FIELDS) == Member;
+            } else {
+                return false;
+            }
+        }
+
+        template<auto Member>
+        static constexpr size_t field_index() {
+            constexpr auto index = []<size_t... I>(std::index_sequence<I...>) {
+                size_t found = FIELD_COUNT;
+                ((is_field<I, Member>() ? (found = I) : 0), ...);
+                return found;
+            }(FIELD_INDICES);
+            static_assert(index < FIELD_COUNT, "Member is not a field of the SoA layout");
+            return index;
+        }
+
+        template<size_t... I>
+        reference proxy(size_t index, std::index_sequence<I...>) {
+            return reference { std::get<I>(m_fields)[index]... };
+        }
+        template<size_t... I>
+        const_reference proxy(size_t index, std::index_sequence<I...>) const {
+            return const_reference { std::get<I>(m_fields)[index]... };
+        }
+
+        template<size_t... I>
+        void push_back(const Component& c, std::index_sequence<I...>) {
+            (std::get<I>(m_fields).push_back(c.*std::get<I>(Layout::FIELDS)), ...);
+        }
+
+        template<size_t... I>
+        void move_field_values(size_t from, size_t to, std::index_sequence<I...>) {
+            ((std::get<I>(m_fields)[to] = std::get<I>(m_fields)[from]), ...);
+        }
+
+        template<size_t... I>
+        void pop_back(std::index_sequence<I...>) {
+            (std::get<I>(m_fields).pop_back(), ...);
+        }
+    };
+
+}
+
+// Declares the SoA layout of a component for SoaStorage, listing its fields:
+//
+//      EMBER_SOA_COMPONENT(ember::physics::ParticleComponent, position, velocity, ...)
+//
+// Must be used at global scope with the fully qualified component name, before the
+// component is used with a storage. Supports up to 16 fields.
+#define EMBER_SOA_COMPONENT(Type, ...)                                                      \
+    template<>                                                                              \
+    struct ember::ecs::SoaLayout<Type> {                                                    \
+        static constexpr auto FIELDS = std::tuple_cat(                                      \
+            std::tuple<>() EMBER_SOA_DETAIL_FOR_EACH(EMBER_SOA_DETAIL_POINTER, Type, __VA_ARGS__) \
+        );                                                                                  \
+                                                                                            \
+        template<bool CONST>                                                                \
+        struct Proxy {                                                                      \
+            EMBER_SOA_DETAIL_FOR_EACH(EMBER_SOA_DETAIL_REFERENCE, Type, __VA_ARGS__)        \
+                                                                                            \
+            operator Type() const {                                                         \
+                Type c{};                                                                   \
+                EMBER_SOA_DETAIL_FOR_EACH(EMBER_SOA_DETAIL_GATHER, Type, __VA_ARGS__)       \
+                return c;                                                                   \
+            }                                                                               \
+            const Proxy& operator=(const Type& c) const requires (!CONST) {                 \
+                EMBER_SOA_DETAIL_FOR_EACH(EMBER_SOA_DETAIL_SCATTER, Type, __VA_ARGS__)      \
+                return *this;                                                               \
+            }                                                                               \
+            const Proxy& operator=(const Proxy& other) const requires (!CONST) {            \
+                return *this = Type(other);                                                 \
+            }                                                                               \
+        };                                                                                  \
+    };
+
+#define EMBER_SOA_DETAIL_POINTER(Type, field) , std::make_tuple(&Type::field)
+#define EMBER_SOA_DETAIL_REFERENCE(Type, field) \
+    std::conditional_t<CONST, const decltype(Type::field)&, decltype(Type::field)&> field;
+#define EMBER_SOA_DETAIL_GATHER(Type, field) c.field = field;
+#define EMBER_SOA_DETAIL_SCATTER(Type, field) field = c.field;
+
+#define EMBER_SOA_DETAIL_EXPAND(x) x
+#define EMBER_SOA_DETAIL_FE_1(M, T, x) M(T, x)
+#define EMBER_SOA_DETAIL_FE_2(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_1(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_3(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_2(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_4(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_3(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_5(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_4(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_6(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_5(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_7(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_6(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_8(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_7(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_9(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_8(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_10(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_9(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_11(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_10(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_12(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_11(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_13(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_12(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_14(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_13(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_15(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_14(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_FE_16(M, T, x, ...) M(T, x) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_FE_15(M, T, __VA_ARGS__))
+#define EMBER_SOA_DETAIL_GET_FE(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, NAME, ...) NAME
+#define EMBER_SOA_DETAIL_FOR_EACH(M, T, ...) EMBER_SOA_DETAIL_EXPAND(EMBER_SOA_DETAIL_GET_FE(__VA_ARGS__, \
+    EMBER_SOA_DETAIL_FE_16, EMBER_SOA_DETAIL_FE_15, EMBER_SOA_DETAIL_FE_14, EMBER_SOA_DETAIL_FE_13, \
+    EMBER_SOA_DETAIL_FE_12, EMBER_SOA_DETAIL_FE_11, EMBER_SOA_DETAIL_FE_10, EMBER_SOA_DETAIL_FE_9, \
+    EMBER_SOA_DETAIL_FE_8, EMBER_SOA_DETAIL_FE_7, EMBER_SOA_DETAIL_FE_6, EMBER_SOA_DETAIL_FE_5, \
+    EMBER_SOA_DETAIL_FE_4, EMBER_SOA_DETAIL_FE_3, EMBER_SOA_DETAIL_FE_2, EMBER_SOA_DETAIL_FE_1)(M, T, __VA_ARGS__))
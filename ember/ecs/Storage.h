@@ -1,24 +1,35 @@
 #pragma once
 
+#include <algorithm>
 #include <concepts>
 #include <map>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "ChangeTick.h"
 #include "Entity.h"
 #include "EntitySet.h"
+#include "Snapshot.h"
+#include "StorageHooks.h"
 
 namespace ember::ecs {
 
+    // Components are handed out through the reference types of the storage. They are
+    // plain references except for storages that never hold a whole component in one
+    // place (SoaStorage), which return proxies instead.
     template<typename T>
     concept ComponentStorage = requires(const T const_s, T s, Entity e, const T::Component& c) {
         typename T::Component;
+        typename T::reference;
+        typename T::const_reference;
         typename T::iterator;
         typename T::const_iterator;
 
         { const_s.contains(e) } -> std::convertible_to<bool>;
-        { const_s[e] } -> std::same_as<const typename T::Component&>;
-        { const_s.at(e) } -> std::same_as<const typename T::Component&>;
+        { const_s[e] } -> std::same_as<typename T::const_reference>;
+        { const_s.at(e) } -> std::same_as<typename T::const_reference>;
         { const_s.begin() } -> std::same_as<typename T::const_iterator>;
         { const_s.end() } -> std::same_as<typename T::const_iterator>;
         { const_s.entities() } -> std::same_as<const EntitySet&>;
@@ -26,16 +37,46 @@ namespace ember::ecs {
 
         s.insert(e, c);
         s.remove(e);
-        { s[e] } -> std::same_as<typename T::Component&>;
-        { s.at(e) } -> std::same_as<typename T::Component&>;
+        { s[e] } -> std::same_as<typename T::reference>;
+        { s.at(e) } -> std::same_as<typename T::reference>;
         { s.begin() } -> std::same_as<typename T::iterator>;
         { s.end() } -> std::same_as<typename T::iterator>;
     };
 
+    namespace detail {
+        // Throws unless every valid entity loaded from a snapshot has a component and
+        // there are count of them
+        inline void check_valid_snapshot(const EntitySet& valid, size_t components, size_t count) {
+            size_t found = 0;
+            for (const auto e : valid) {
+                if (e.id >= components) throw std::runtime_error("Snapshot storage has an invalid entity!");
+                found++;
+            }
+            if (found != count) throw std::runtime_error("Snapshot storage has an invalid size!");
+        }
+
+        // Throws unless sparse and entities loaded from a snapshot map onto each other,
+        // so a corrupt or mismatched file cannot index out of bounds later on
+        inline void check_sparse_snapshot(std::span<const uint32_t> sparse, std::span<const Entity> entities) {
+            constexpr auto NO_INDEX = ~uint32_t(0);
+            size_t mapped = 0;
+            for (size_t id = 0; id < sparse.size(); id++) {
+                if (sparse[id] == NO_INDEX) continue;
+                if ((sparse[id] >= entities.size()) || (entities[sparse[id]].id != id)) {
+                    throw std::runtime_error("Snapshot storage has an invalid sparse index!");
+                }
+                mapped++;
+            }
+            if (mapped != entities.size()) throw std::runtime_error("Snapshot storage has an invalid sparse index!");
+        }
+    }
+
     template<typename T>
     class VectorStorage {
     public:
         using Component = T;
+        using reference = T&;
+        using const_reference = const T&;
         using iterator = std::vector<T>::iterator;
         using const_iterator = std::vector<T>::const_iterator;
 
@@ -44,18 +85,49 @@ namespace ember::ecs {
 
         void insert(Entity e, const Component& c) {
             maybe_resize(e);
+            // Same id with a stale generation is removed first so it is counted and
+            // reported to the hooks only once. Dead handles of an older generation are
+            // ignored rather than overwriting the live entity.
+            const auto current = m_valid.iter_from(e.id);
+            if ((current != m_valid.end()) && ((*current).id == e.id) && ((*current).generation != e.generation)) {
+                if (!newer_generation(e, *current)) return;
+                remove(*current);
+            }
+
+            const auto tick = touch();
+            if (!m_valid.contains(e)) {
+                m_count++;
+                m_ticks[e.id] = { tick, tick };
+            } else {
+                m_ticks[e.id].changed = tick;
+            }
+            const auto added = !m_valid.contains(e);
             m_valid.insert(e);
             m_components[e.id] = c;
+            if (added) m_hooks.inserted(e);
+            else m_hooks.replaced(e);
         }
 
         void remove(Entity e) {
+            // EntitySet::remove ignores the generation so stale entities must not get there
+            if (!m_valid.contains(e)) throw std::out_of_range("Attempted to remove invalid component!");
+            m_hooks.removing(e);
+            touch();
             m_valid.remove(e);
+            m_count--;
+        }
+
+        void remove_range(std::span<const Entity> entities) {
+            for (const auto e : entities) {
+                if (contains(e)) remove(e);
+            }
         }
 
         const T& operator[](Entity e) const {
             return m_components[e.id];
         }
         T& operator[](Entity e) {
+            m_ticks[e.id].changed = touch();
             return m_components[e.id];
         }
 
@@ -65,13 +137,16 @@ namespace ember::ecs {
         }
         T& at(Entity e) {
             if (!m_valid[e]) throw std::out_of_range("Attempted to access invalid component!");
+            m_ticks[e.id].changed = touch();
             return m_components.at(e.id);
         }
 
         const_iterator begin() const {
             return m_components.begin();
         }
+        // Mutable iteration may touch any component so it marks all of them changed
         iterator begin() {
+            mark_all_changed();
             return m_components.begin();
         }
 
@@ -82,69 +157,201 @@ namespace ember::ecs {
             return m_components.end();
         }
 
-        inline size_t size() const { m_valid.size(); }
+        inline size_t size() const { return m_count; }
+
+        // Make room for entity ids below count without reallocating on insert
+        void reserve(size_t count) {
+            m_components.reserve(count);
+            m_ticks.reserve(count);
+            if (count > m_valid.size()) m_valid.resize(count);
+        }
+
+        inline const ComponentTicks& ticks(Entity e) const { return m_ticks[e.id]; }
+        inline void bind_ticks(const Tick& tick) { m_tick = &tick; }
+        // Last tick any component was inserted, removed or mutably accessed
+        inline Tick modified_tick() const { return m_modified; }
+        // Stamp the storage modified at the current tick, see ModifiedStorage
+        Tick touch() {
+            const auto tick = now();
+            if (m_modified != tick) m_modified = tick;
+            return tick;
+        }
+        // Stamp every component changed at the current tick
+        void mark_all_changed() {
+            const auto tick = touch();
+            for (auto& ticks : m_ticks) ticks.changed = tick;
+        }
+        inline StorageHooks& hooks() { return m_hooks; }
+
+        void write_snapshot(SnapshotWriter& writer) const requires std::is_trivially_copyable_v<T> {
+            writer.write_value(uint64_t(m_count));
+            writer.write_block(std::span<const T>(m_components));
+            writer.write_block(std::span<const ComponentTicks>(m_ticks));
+            m_valid.write_snapshot(writer);
+        }
+
+        // Replaces the contents, running remove hooks for the old entities and insert
+        // hooks for the new ones
+        void read_snapshot(SnapshotReader& reader) requires std::is_trivially_copyable_v<T> {
+            if (!m_hooks.empty()) for (const auto e : m_valid) m_hooks.removing(e);
+            touch();
+
+            m_count = size_t(reader.read_value<uint64_t>());
+            reader.read_into(m_components);
+            reader.read_into(m_ticks);
+            m_valid.read_snapshot(reader);
+            if (m_ticks.size() != m_components.size()) throw std::runtime_error("Snapshot storage has an invalid size!");
+            detail::check_valid_snapshot(m_valid, m_components.size(), m_count);
+
+            if (!m_hooks.empty()) for (const auto e : m_valid) m_hooks.inserted(e);
+        }
 
     private:
         std::vector<T> m_components;
+        std::vector<ComponentTicks> m_ticks;
         EntitySet m_valid;
+        size_t m_count = 0;
+        StorageHooks m_hooks;
+
+        // Unbound storages stamp every change with tick 0
+        const Tick* m_tick = nullptr;
+
+        // Tick of the last change to any component, see modified_tick()
+        Tick m_modified = 0;
+
+        inline Tick now() const { return m_tick ? *m_tick : 0; }
 
         void maybe_resize(Entity e) {
             if (e.id >= m_components.size()) {
                 m_components.resize(e.id+1);
+                m_ticks.resize(e.id+1);
             }
         }
     };
     static_assert(ComponentStorage<VectorStorage<int>>);
+    static_assert(TrackedStorage<VectorStorage<int>>);
+    static_assert(HookedStorage<VectorStorage<int>>);
+    static_assert(SnapshotStorage<VectorStorage<int>>);
 
+    // Sparse set storage: components are packed contiguously next to a packed array of
+    // their entities, and a sparse array maps entity ids to packed indices. Insert, remove
+    // and lookup are all O(1) and iteration is a linear walk over the packed components.
     template<typename T>
-    class DenseVectorStorage {
+    class SparseSetStorage {
     public:
         using Component = T;
+        using reference = T&;
+        using const_reference = const T&;
         using iterator = std::vector<T>::iterator;
         using const_iterator = std::vector<T>::const_iterator;
 
-        inline bool contains(Entity e) const { return m_id_map.contains(e); }
-        inline const EntitySet& entities() const { return m_id_map.entities(); }
+        inline bool contains(Entity e) const {
+            return (e.id < m_sparse.size())
+                && (m_sparse[e.id] != NO_INDEX)
+                && (m_entities[m_sparse[e.id]].generation == e.generation);
+        }
+        inline const EntitySet& entities() const { return m_valid; }
 
         void insert(Entity e, const Component& c) {
-            if (m_id_map.contains(e)) {
-                this->at(e) = c;
+            if (e.id >= m_sparse.size()) m_sparse.resize(e.id+1, NO_INDEX);
+
+            const auto index = m_sparse[e.id];
+            // Same id with a stale generation is replaced in place, while dead handles
+            // of an older generation are ignored rather than overwriting the live entity
+            const auto stale = (index != NO_INDEX) && (m_entities[index].generation != e.generation);
+            if (stale && !newer_generation(e, m_entities[index])) return;
+
+            const auto tick = touch();
+            if (index != NO_INDEX) {
+                if (stale) {
+                    m_hooks.removing(m_entities[index]);
+                    m_ticks[index].added = tick;
+                }
+                m_ticks[index].changed = tick;
+                m_entities[index] = e;
+                m_components[index] = c;
+                m_valid.insert(e);
+                if (stale) m_hooks.inserted(e);
+                else m_hooks.replaced(e);
             } else {
-                m_id_map.insert(e, m_components.size());
+                m_sparse[e.id] = uint32_t(m_components.size());
+                m_entities.push_back(e);
                 m_components.push_back(c);
+                m_ticks.push_back({ tick, tick });
+                m_valid.insert(e);
+                m_hooks.inserted(e);
+            }
+        }
+
+        void insert_range(std::span<const Entity> entities, std::span<const Component> components) {
+            if (entities.size() != components.size()) {
+                throw std::invalid_argument("insert_range requires one component per entity");
+            }
+
+            uint32_t max_id = 0;
+            for (const auto e : entities) max_id = std::max(max_id, e.id);
+            if (max_id >= m_sparse.size()) m_sparse.resize(max_id+1, NO_INDEX);
+            if (max_id >= m_valid.size()) m_valid.resize(max_id+1);
+
+            m_entities.reserve(m_entities.size() + entities.size());
+            m_components.reserve(m_components.size() + components.size());
+            m_ticks.reserve(m_ticks.size() + components.size());
+
+            for (auto i = 0; i < entities.size(); i++) {
+                insert(entities[i], components[i]);
             }
         }
 
         void remove(Entity e) {
-            auto index = m_id_map.at(e);
-            m_components[index] = m_components.back();
-            m_components.resize(m_components.size()-1);
-            for (auto& id : m_id_map) {
-                if (id == m_components.size()) {
-                    id = index;
-                    break;
-                }
+            if (!contains(e)) throw std::out_of_range("Attempted to remove invalid component!");
+            m_hooks.removing(e);
+            touch();
+
+            const auto index = m_sparse[e.id];
+            const auto last = m_components.size() - 1;
+            if (index != last) {
+                m_components[index] = m_components[last];
+                m_entities[index] = m_entities[last];
+                m_ticks[index] = m_ticks[last];
+                m_sparse[m_entities[index].id] = index;
+            }
+            m_components.pop_back();
+            m_entities.pop_back();
+            m_ticks.pop_back();
+            m_sparse[e.id] = NO_INDEX;
+            m_valid.remove(e);
+        }
+
+        void remove_range(std::span<const Entity> entities) {
+            for (const auto e : entities) {
+                if (contains(e)) remove(e);
             }
         }
 
         const T& operator[](Entity e) const {
-            return m_components[m_id_map[e]];
+            return m_components[m_sparse[e.id]];
         }
         T& operator[](Entity e) {
-            return m_components[m_id_map[e]];
+            const auto index = m_sparse[e.id];
+            m_ticks[index].changed = touch();
+            return m_components[index];
         }
 
         const T& at(Entity e) const {
-            return m_components.at(m_id_map.at(e));
+            if (!contains(e)) throw std::out_of_range("Attempted to access invalid component!");
+            return m_components[m_sparse[e.id]];
         }
         T& at(Entity e) {
-            return m_components.at(m_id_map.at(e));
+            if (!contains(e)) throw std::out_of_range("Attempted to access invalid component!");
+            return (*this)[e];
         }
 
         const_iterator begin() const {
             return m_components.begin();
         }
+        // Mutable iteration may touch any component so it marks all of them changed
         iterator begin() {
+            mark_all_changed();
             return m_components.begin();
         }
 
@@ -155,18 +362,100 @@ namespace ember::ecs {
             return m_components.end();
         }
 
-        inline size_t size() const { m_id_map.size(); }
+        inline size_t size() const { return m_components.size(); }
+        void reserve(size_t count) {
+            m_entities.reserve(count);
+            m_components.reserve(count);
+            m_ticks.reserve(count);
+        }
+
+        inline const ComponentTicks& ticks(Entity e) const { return m_ticks[m_sparse[e.id]]; }
+        inline void bind_ticks(const Tick& tick) { m_tick = &tick; }
+        // Last tick any component was inserted, removed or mutably accessed
+        inline Tick modified_tick() const { return m_modified; }
+        // Stamp the storage modified at the current tick, see ModifiedStorage
+        Tick touch() {
+            const auto tick = now();
+            if (m_modified != tick) m_modified = tick;
+            return tick;
+        }
+        // Stamp every component changed at the current tick
+        void mark_all_changed() {
+            const auto tick = touch();
+            for (auto& ticks : m_ticks) ticks.changed = tick;
+        }
+        inline StorageHooks& hooks() { return m_hooks; }
+
+        void write_snapshot(SnapshotWriter& writer) const requires std::is_trivially_copyable_v<T> {
+            writer.write_block(std::span<const uint32_t>(m_sparse));
+            writer.write_block(std::span<const Entity>(m_entities));
+            writer.write_block(std::span<const T>(m_components));
+            writer.write_block(std::span<const ComponentTicks>(m_ticks));
+            m_valid.write_snapshot(writer);
+        }
+
+        // Replaces the contents, running remove hooks for the old entities and insert
+        // hooks for the new ones
+        void read_snapshot(SnapshotReader& reader) requires std::is_trivially_copyable_v<T> {
+            if (!m_hooks.empty()) for (const auto e : m_entities) m_hooks.removing(e);
+            touch();
+
+            reader.read_into(m_sparse);
+            reader.read_into(m_entities);
+            reader.read_into(m_components);
+            reader.read_into(m_ticks);
+            m_valid.read_snapshot(reader);
+            if ((m_entities.size() != m_components.size()) || (m_ticks.size() != m_components.size())) {
+                throw std::runtime_error("Snapshot storage has an invalid size!");
+            }
+            detail::check_sparse_snapshot(m_sparse, m_entities);
+
+            if (!m_hooks.empty()) for (const auto e : m_entities) m_hooks.inserted(e);
+        }
+
+        // Packed arrays, index i of one corresponds to index i of the other
+        inline std::span<const Entity> packed_entities() const { return m_entities; }
+        inline std::span<const T> packed_components() const { return m_components; }
+        inline std::span<T> packed_components() {
+            mark_all_changed();
+            return m_components;
+        }
+        inline std::span<const ComponentTicks> packed_ticks() const { return m_ticks; }
 
     private:
-        VectorStorage<size_t> m_id_map;
+        static constexpr uint32_t NO_INDEX = ~uint32_t(0);
+
+        std::vector<uint32_t> m_sparse;
+        std::vector<Entity> m_entities;
         std::vector<T> m_components;
+        std::vector<ComponentTicks> m_ticks;
+        EntitySet m_valid;
+        StorageHooks m_hooks;
+
+        // Unbound storages stamp every change with tick 0
+        const Tick* m_tick = nullptr;
+
+        // Tick of the last change to any component, see modified_tick()
+        Tick m_modified = 0;
+
+        inline Tick now() const { return m_tick ? *m_tick : 0; }
     };
-    static_assert(ComponentStorage<DenseVectorStorage<int>>);
+    static_assert(ComponentStorage<SparseSetStorage<int>>);
+    static_assert(TrackedStorage<SparseSetStorage<int>>);
+    static_assert(HookedStorage<SparseSetStorage<int>>);
+    static_assert(SnapshotStorage<SparseSetStorage<int>>);
+
+    // DenseVectorStorage used to keep an id -> index map that had to be scanned on
+    // remove; the sparse set gives the same packed layout with O(1) removal.
+    template<typename T>
+    using DenseVectorStorage = SparseSetStorage<T>;
 
     template<typename T>
     class MapStorage {
     public:
         using Component = T;
+        using reference = T&;
+        using const_reference = const T&;
         using iterator = std::map<Entity, T>::iterator;
         using const_iterator = std::map<Entity, T>::const_iterator;
 
@@ -174,19 +463,34 @@ namespace ember::ecs {
         inline const EntitySet& entities() const { return m_valid; }
 
         void insert(Entity e, const Component& c) {
+            // The map orders entities by id only, so a stale generation is removed first
+            // and dead handles of an older generation are ignored
+            const auto current = m_valid.iter_from(e.id);
+            if ((current != m_valid.end()) && ((*current).id == e.id) && ((*current).generation != e.generation)) {
+                if (!newer_generation(e, *current)) return;
+                remove(*current);
+            }
+
+            touch();
+            const auto added = !m_valid.contains(e);
             m_valid.insert(e);
             m_components.insert_or_assign(e, c);
+            if (added) m_hooks.inserted(e);
+            else m_hooks.replaced(e);
         }
 
         void remove(Entity e) {
+            if (m_valid.contains(e)) m_hooks.removing(e);
+            touch();
             m_components.erase(e);
             m_valid.remove(e);
         }
 
         const T& operator[](Entity e) const {
-            return m_components[e];
+            return m_components.find(e)->second;
         }
         T& operator[](Entity e) {
+            touch();
             return m_components[e];
         }
 
@@ -194,6 +498,7 @@ namespace ember::ecs {
             return m_components.at(e);
         }
         T& at(Entity e) {
+            touch();
             return m_components.at(e);
         }
 
@@ -201,6 +506,7 @@ namespace ember::ecs {
             return m_components.begin();
         }
         iterator begin() {
+            touch();
             return m_components.begin();
         }
 
@@ -211,12 +517,67 @@ namespace ember::ecs {
             return m_components.end();
         }
 
-        inline size_t size() const { m_valid.size(); }
+        inline size_t size() const { return m_components.size(); }
+
+        inline void bind_ticks(const Tick& tick) { m_tick = &tick; }
+        // Last tick any component was inserted, removed or mutably accessed
+        inline Tick modified_tick() const { return m_modified; }
+        // Stamp the storage modified at the current tick, see ModifiedStorage
+        Tick touch() {
+            const auto tick = now();
+            if (m_modified != tick) m_modified = tick;
+            return tick;
+        }
+        inline StorageHooks& hooks() { return m_hooks; }
+
+        void write_snapshot(SnapshotWriter& writer) const requires std::is_trivially_copyable_v<T> {
+            std::vector<Entity> entities;
+            std::vector<T> components;
+            entities.reserve(m_components.size());
+            components.reserve(m_components.size());
+            for (const auto& [e, c] : m_components) {
+                entities.push_back(e);
+                components.push_back(c);
+            }
+            writer.write_block(std::span<const Entity>(entities));
+            writer.write_block(std::span<const T>(components));
+        }
+
+        // Replaces the contents, running remove hooks for the old entities and insert
+        // hooks for the new ones
+        void read_snapshot(SnapshotReader& reader) requires std::is_trivially_copyable_v<T> {
+            if (!m_hooks.empty()) for (const auto& [e, c] : m_components) m_hooks.removing(e);
+            touch();
+
+            const auto entities = reader.read_block<Entity>();
+            const auto components = reader.read_block<T>();
+            if (entities.size() != components.size()) throw std::runtime_error("Snapshot storage has an invalid size!");
+
+            // Entities were written in order so every insert goes at the end of the map
+            m_components.clear();
+            m_valid.resize(0);
+            for (auto i = 0; i < entities.size(); i++) {
+                m_components.emplace_hint(m_components.end(), entities[i], components[i]);
+                m_valid.insert(entities[i]);
+            }
+
+            if (!m_hooks.empty()) for (const auto e : entities) m_hooks.inserted(e);
+        }
 
     private:
         std::map<Entity, T> m_components;
         EntitySet m_valid;
+        StorageHooks m_hooks;
+
+        // Unbound storages stamp every change with tick 0
+        const Tick* m_tick = nullptr;
+        Tick m_modified = 0;
+
+        inline Tick now() const { return m_tick ? *m_tick : 0; }
     };
     static_assert(ComponentStorage<MapStorage<int>>);
+    static_assert(ModifiedStorage<MapStorage<int>>);
+    static_assert(HookedStorage<MapStorage<int>>);
+    static_assert(SnapshotStorage<MapStorage<int>>);
 
 }
\ No newline at end of file
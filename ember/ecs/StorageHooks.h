@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Entity.h"
+
+namespace ember::ecs {
+
+    // Callbacks a storage runs on structural changes. Insert hooks run once the
+    // component is in place and only when the entity did not already hold one,
+    // replace hooks when an insert overwrote the component of the same entity and
+    // remove hooks while the component is still readable. Hooks must not
+    // insert into or remove from the storage that runs them.
+    class StorageHooks {
+    public:
+        using Hook = std::function<void(Entity)>;
+        using HookId = size_t;
+
+        HookId on_insert(Hook hook) {
+            m_on_insert.push_back({ m_next_id, std::move(hook) });
+            return m_next_id++;
+        }
+
+        HookId on_replace(Hook hook) {
+            m_on_replace.push_back({ m_next_id, std::move(hook) });
+            return m_next_id++;
+        }
+
+        HookId on_remove(Hook hook) {
+            m_on_remove.push_back({ m_next_id, std::move(hook) });
+            return m_next_id++;
+        }
+
+        void remove_hook(HookId id) {
+            const auto matches = [id](const auto& entry) { return entry.first == id; };
+            std::erase_if(m_on_insert, matches);
+            std::erase_if(m_on_replace, matches);
+            std::erase_if(m_on_remove, matches);
+        }
+
+        inline bool empty() const { return m_on_insert.empty() && m_on_replace.empty() && m_on_remove.empty(); }
+
+        inline void inserted(Entity e) const {
+            for (const auto& [id, hook] : m_on_insert) hook(e);
+        }
+
+        inline void replaced(Entity e) const {
+            for (const auto& [id, hook] : m_on_replace) hook(e);
+        }
+
+        inline void removing(Entity e) const {
+            for (const auto& [id, hook] : m_on_remove) hook(e);
+        }
+
+    private:
+        std::vector<std::pair<HookId, Hook>> m_on_insert;
+        std::vector<std::pair<HookId, Hook>> m_on_replace;
+        std::vector<std::pair<HookId, Hook>> m_on_remove;
+        HookId m_next_id = 0;
+    };
+
+    template<typename S>
+    concept HookedStorage = requires(S s) {
+        { s.hooks() } -> std::same_as<StorageHooks&>;
+    };
+
+}
@@ -1,18 +1,70 @@
 #pragma once
 
 #include <concepts>
+#include <type_traits>
+#include <vector>
+
+#include "TypeId.h"
 
 namespace ember::ecs {
 
     class World;
 
+    // Components (or resources) a system reads and writes, used by SystemGraphBuilder
+    // to keep conflicting systems out of the same parallel phase.
+    struct AccessInfo {
+        bool declared = false;
+        std::vector<TypeId> reads;
+        std::vector<TypeId> writes;
+
+        bool conflicts_with(const AccessInfo& other) const;
+    };
+
+    template<typename... T>
+    struct Read {
+        static void collect(AccessInfo& info) {
+            (info.reads.push_back(type_id<T>()), ...);
+        }
+    };
+
+    template<typename... T>
+    struct Write {
+        static void collect(AccessInfo& info) {
+            (info.writes.push_back(type_id<T>()), ...);
+        }
+    };
+
+    // Declared by a system as e.g.
+    //      using Access = ecs::Access<ecs::Read<TransformComponent>, ecs::Write<RigidBodyComponent>>;
+    template<typename... Clauses>
+    struct Access {
+        static AccessInfo info() {
+            AccessInfo info;
+            info.declared = true;
+            (Clauses::collect(info), ...);
+            return info;
+        }
+    };
+
+    template<typename T>
+    concept SystemAccess = requires {
+        { T::info() } -> std::same_as<AccessInfo>;
+    };
+
+    // Systems may optionally declare their component access through an Access typedef
     template<typename T>
     concept System = requires(World& world, float dt) {
         T::init(world);
         T::run(world, dt);
-    };
+    } && (!requires { typename T::Access; } || SystemAccess<typename T::Access>);
+
+    template<System S>
+    AccessInfo system_access() {
+        if constexpr (requires { typename S::Access; }) return S::Access::info();
+        else return AccessInfo();
+    }
 
     typedef void(*SystemCreateFn)(World& world);
     typedef void(*SystemRunFn)(World& world, float dt);
 
-}
\ No newline at end of file
+}
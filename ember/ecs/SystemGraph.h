@@ -2,19 +2,39 @@
 
 #include <map>
 #include <set>
+#include <string_view>
 #include <vector>
 
+#include "RunPolicy.h"
 #include "System.h"
+#include "TypeId.h"
 
 namespace ember::ecs {
 
     using SystemGraph = std::vector<std::set<SystemRunFn>>;
 
+    namespace detail {
+        void register_system_name(SystemRunFn sys, std::string_view name);
+        void register_system_policy(SystemRunFn sys, RunPolicy policy);
+    }
+
+    // Name of a system added to any SystemGraphBuilder, empty for unknown systems
+    std::string_view system_name(SystemRunFn sys);
+
+    // Declared run policy of a system added to any SystemGraphBuilder, always run
+    // for unknown systems
+    RunPolicy system_run_policy(SystemRunFn sys);
+
     class SystemGraphBuilder {
     public:
         template<System S>
         void add_system() {
-            m_systems.insert(S::run);
+            if (m_systems.insert(S::run).second) {
+                m_order.push_back(S::run);
+                m_access.insert({ S::run, system_access<S>() });
+                detail::register_system_name(S::run, type_name<S>());
+                detail::register_system_policy(S::run, system_run_policy<S>());
+            }
             m_dependencies.insert({ S::run, {} });
         }
 
@@ -25,11 +45,18 @@ namespace ember::ecs {
             m_dependencies.at(Dst::run).insert(Src::run);
         }
 
+        // Layer the systems into phases. A system is placed in the first phase after all of
+        // its ordering dependencies in which it does not conflict with the declared access of
+        // any other system of that phase. Conflicts are resolved in registration order and
+        // systems that do not declare their access conflict with every other system, so
+        // they always run alone in their phase.
         SystemGraph build();
 
     private:
         std::set<SystemRunFn> m_systems;
+        std::vector<SystemRunFn> m_order;
+        std::map<SystemRunFn, AccessInfo> m_access;
         std::map<SystemRunFn, std::set<SystemRunFn>> m_dependencies;
     };
 
-}
\ No newline at end of file
+}
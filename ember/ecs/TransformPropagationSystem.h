@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ChangeTick.h"
+#include "Entity.h"
+#include "GlobalTransformComponent.h"
+#include "ParentComponent.h"
+#include "StorageHooks.h"
+#include "System.h"
+#include "TransformComponent.h"
+#include "World.h"
+
+namespace ember::ecs {
+
+    // out = parent * local, using SSE when available
+    void multiply_transforms(const glm::mat4& parent, const glm::mat4& local, glm::mat4& out);
+
+    // Entities with a TransformComponent sorted by their depth in the hierarchy. Kept
+    // as a world resource by TransformPropagationSystem and updated incrementally:
+    // storage hooks record the entities that gained or lost a transform or a parent,
+    // and only those and their subtrees move between levels on the next update.
+    class TransformHierarchy {
+    public:
+        struct Node {
+            Entity entity;
+            Entity parent; // INVALID_ENTITY for roots
+        };
+
+        TransformHierarchy() = default;
+        TransformHierarchy(TransformHierarchy&& other) {
+            if (other.attached()) throw std::logic_error("Cannot move an attached TransformHierarchy");
+        }
+        TransformHierarchy(const TransformHierarchy&) = delete;
+        TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+        ~TransformHierarchy();
+
+        // Start tracking the storages, the hooks are removed again on destruction
+        void attach(TransformComponent::Storage& transforms, ParentComponent::Storage& parents);
+        inline bool attached() const { return m_transforms != nullptr; }
+
+        inline size_t level_count() const { return m_levels.size(); }
+        inline std::span<const Node> level(size_t i) const { return m_levels[i]; }
+
+        // Record a structural change of the entity with the given id
+        void mark_dirty(uint32_t id);
+
+        // Rebuild from scratch on the next update
+        inline void invalidate() { m_stale = true; }
+        inline bool stale() const { return m_stale; }
+
+        // Move the dirty entities and their subtrees to their new levels, or rebuild
+        // every level when invalidated. Throws std::logic_error if the parents form a
+        // cycle, the next update then rebuilds.
+        void update(World& world);
+
+        // Recompute the global transform of every entity whose transform changed after
+        // since, that moved in the hierarchy or whose parent was recomputed, one level
+        // at a time
+        void propagate(World& world, Tick since);
+
+    private:
+        static constexpr uint32_t UNVISITED = ~uint32_t(0);
+        static constexpr uint32_t VISITING = UNVISITED - 1;
+
+        TransformComponent::Storage* m_transforms = nullptr;
+        ParentComponent::Storage* m_parents = nullptr;
+        std::array<StorageHooks::HookId, 5> m_hooks {};
+
+        std::vector<std::vector<Node>> m_levels;
+        bool m_stale = true;
+        std::vector<uint32_t> m_dirty;
+
+        // Indexed by entity id
+        std::vector<uint32_t> m_depth;
+        std::vector<uint32_t> m_slot;
+        std::vector<uint32_t> m_child_count;
+        std::vector<uint8_t> m_is_dirty;
+        std::vector<uint8_t> m_moved;
+        std::vector<uint8_t> m_updated;
+
+        void push_dirty(uint32_t id);
+        void detach(uint32_t id);
+        uint32_t depth(Entity e, const TransformComponent::Storage& transforms, const ParentComponent::Storage& parents, GlobalTransformComponent::Storage& globals);
+    };
+
+    // Computes GlobalTransformComponent from the TransformComponent of every entity and
+    // its ParentComponent chain. Levels of the hierarchy are processed in order, each one
+    // in parallel on the world thread pool, and subtrees whose transforms did not change
+    // since the last run are skipped.
+    class TransformPropagationSystem {
+    public:
+        using Access = ecs::Access<Read<TransformComponent, ParentComponent>, Write<GlobalTransformComponent, TransformHierarchy>>;
+
+        static void init(World& world);
+        static void run(World& world, float dt);
+    };
+    static_assert(System<TransformPropagationSystem>);
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace ember::ecs {
+
+    // Dense integer identifying a component or resource type. Ids are handed out in
+    // order of first use starting at 0 so they can index flat arrays directly, which
+    // keeps RTTI and hashing off the hot path of storage lookups.
+    using TypeId = uint32_t;
+
+    static constexpr TypeId INVALID_TYPE_ID = std::numeric_limits<TypeId>::max();
+
+    namespace detail {
+        TypeId next_type_id();
+
+        template<typename T>
+        TypeId type_id() {
+            static const TypeId id = next_type_id();
+            return id;
+        }
+    }
+
+    // const T and T share an id
+    template<typename T>
+    inline TypeId type_id() {
+        return detail::type_id<std::remove_cv_t<T>>();
+    }
+
+    // Readable name of T taken from __PRETTY_FUNCTION__, for diagnostics and profiling.
+    // The exact spelling (namespaces, struct prefixes) depends on the compiler.
+    template<typename T>
+    constexpr std::string_view type_name() {
+#ifdef _MSC_VER
+        constexpr std::string_view name = __FUNCSIG__;
+        constexpr auto begin = name.find("type_name<") + 10;
+        constexpr auto end = name.rfind(">(void)");
+#else
+        constexpr std::string_view name = __PRETTY_FUNCTION__;
+        constexpr auto begin = name.find("T = ") + 4;
+        constexpr auto end = name.find_first_of(";]", begin);
+#endif
+        return name.substr(begin, end - begin);
+    }
+
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ChangeTick.h"
+#include "Component.h"
+#include "Entity.h"
+#include "EntitySet.h"
+
+namespace ember::ecs {
+
+    // View filters, e.g. view<Changed<const TransformComponent>>() yields only the
+    // transforms written since the running system last ran. Both require a storage
+    // that tracks ticks and yield the component like a plain T would.
+    template<typename T>
+    struct Changed { };
+
+    template<typename T>
+    struct Added { };
+
+    namespace detail {
+        enum class ViewFilter { NONE, CHANGED, ADDED };
+
+        template<typename T>
+        struct ViewTerm {
+            using Component = T;
+            using ConstTerm = const T;
+            static constexpr ViewFilter FILTER = ViewFilter::NONE;
+        };
+
+        template<typename T>
+        struct ViewTerm<Changed<T>> {
+            using Component = T;
+            using ConstTerm = Changed<const T>;
+            static constexpr ViewFilter FILTER = ViewFilter::CHANGED;
+        };
+
+        template<typename T>
+        struct ViewTerm<Added<T>> {
+            using Component = T;
+            using ConstTerm = Added<const T>;
+            static constexpr ViewFilter FILTER = ViewFilter::ADDED;
+        };
+    }
+
+    // Component type (possibly const) yielded for a view term
+    template<typename T>
+    using ViewComponent = typename detail::ViewTerm<T>::Component;
+
+    // Storage type used to access T in a view: const components are read through a
+    // const storage so views double as a declaration of read-only access.
+    template<typename T>
+    using ViewStorage = std::conditional_t<
+        std::is_const_v<ViewComponent<T>>,
+        const typename std::remove_const_t<ViewComponent<T>>::Storage,
+        typename std::remove_const_t<ViewComponent<T>>::Storage
+    >;
+
+    // Reference type yielded for a view term, usually ViewComponent<T>&
+    template<typename T>
+    using ViewReference = std::conditional_t<
+        std::is_const_v<ViewComponent<T>>,
+        typename std::remove_const_t<ViewComponent<T>>::Storage::const_reference,
+        typename std::remove_const_t<ViewComponent<T>>::Storage::reference
+    >;
+
+    template<typename S>
+    concept PackedStorage = requires(const S s) {
+        { s.packed_entities() } -> std::convertible_to<std::span<const Entity>>;
+    };
+
+    // Lazy join over several component storages. Iteration is driven by the smallest
+    // storage, every other storage is only probed with contains() so building and
+    // walking a view never allocates. Dereferencing yields (Entity, T&...), with proxies
+    // in place of T& for SoaStorage components, so
+    //
+    //      for (auto [e, body, transform] : world.view<RigidBodyComponent, const TransformComponent>())
+    //
+    // reads the components directly. Inserting into or removing from a viewed
+    // storage while iterating invalidates the view. Changed and Added terms only
+    // match components whose tick is newer than the since tick of the view.
+    template<typename... T>
+    class View {
+    public:
+        static_assert(sizeof...(T) > 0);
+        static_assert((Component<std::remove_const_t<ViewComponent<T>>> && ...));
+        static_assert(
+            (((detail::ViewTerm<T>::FILTER == detail::ViewFilter::NONE) || TrackedStorage<std::remove_const_t<ViewStorage<T>>>) && ...),
+            "Changed and Added filters require a storage tracking change ticks"
+        );
+
+        using value_type = std::tuple<Entity, ViewReference<T>...>;
+
+        View(ViewStorage<T>&... storages): View(Tick(0), storages...) { }
+
+        View(Tick since, ViewStorage<T>&... storages): m_storages(storages...), m_since(since) {
+            select_driver(std::index_sequence_for<T...>());
+        }
+
+        class iterator {
+        public:
+            using value_type = View::value_type;
+            using difference_type = ptrdiff_t;
+
+            iterator() = default;
+            iterator(const View* view, const Entity* packed, EntitySet::iterator set_iter):
+                m_view(view), m_packed(packed), m_set_iter(set_iter)
+            {
+                skip_invalid();
+            }
+
+            value_type operator*() const {
+                return m_view->get(current(), std::index_sequence_for<T...>());
+            }
+
+            iterator& operator++() {
+                advance();
+                skip_invalid();
+                return *this;
+            }
+
+            iterator operator++(int) {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            bool operator==(const iterator& rhs) const {
+                return (m_packed == rhs.m_packed) && (m_set_iter == rhs.m_set_iter);
+            }
+            bool operator!=(const iterator& rhs) const {
+                return !(*this == rhs);
+            }
+
+        private:
+            const View* m_view = nullptr;
+            const Entity* m_packed = nullptr;
+            EntitySet::iterator m_set_iter;
+
+            inline Entity current() const {
+                return m_view->m_driver_packed ? *m_packed : *m_set_iter;
+            }
+
+            inline void advance() {
+                if (m_view->m_driver_packed) m_packed++;
+                else m_set_iter++;
+            }
+
+            inline bool at_end() const {
+                return m_view->m_driver_packed
+                    ? (m_packed == m_view->m_packed.data() + m_view->m_packed.size())
+                    : (m_set_iter == m_view->m_set->end());
+            }
+
+            void skip_invalid() {
+                while (!at_end() && !m_view->contains(current())) advance();
+            }
+        };
+        static_assert(std::forward_iterator<iterator>);
+
+        iterator begin() const {
+            if (m_driver_packed) return iterator(this, m_packed.data(), EntitySet::iterator());
+            else return iterator(this, nullptr, m_set->begin());
+        }
+
+        iterator end() const {
+            if (m_driver_packed) return iterator(this, m_packed.data() + m_packed.size(), EntitySet::iterator());
+            else return iterator(this, nullptr, m_set->end());
+        }
+
+        // Call fn(Entity, T&...) for every entity holding all of the components
+        template<typename Fn>
+        void each(Fn&& fn) const {
+            for (auto&& row : *this) std::apply(fn, row);
+        }
+
+        // Size of the index range [0, extent) of the driving storage, which can be split
+        // and visited piecewise with each_in(). Used to iterate a view in parallel.
+        inline size_t extent() const {
+            return m_driver_packed ? m_packed.size() : m_set->size();
+        }
+
+        template<typename Fn>
+        void each_in(size_t begin, size_t end, Fn&& fn) const {
+            if (m_driver_packed) {
+                for (auto i = begin; i < end; i++) {
+                    const auto e = m_packed[i];
+                    if (contains(e)) std::apply(fn, get(e, std::index_sequence_for<T...>()));
+                }
+            } else {
+                const auto last = m_set->end();
+                for (auto iter = m_set->iter_from(begin); (iter != last) && ((*iter).id < end); iter++) {
+                    const auto e = *iter;
+                    if (contains(e)) std::apply(fn, get(e, std::index_sequence_for<T...>()));
+                }
+            }
+        }
+
+        bool contains(Entity e) const {
+            return contains(e, std::index_sequence_for<T...>());
+        }
+
+        // Stamp the storages of the mutable terms modified, so that each_in() can then
+        // run from several threads without writing the shared stamps
+        void touch() {
+            touch(std::index_sequence_for<T...>());
+        }
+
+        // Upper bound on the number of entities the view yields
+        inline size_t size_hint() const { return m_size_hint; }
+
+        inline Tick since() const { return m_since; }
+
+    private:
+        std::tuple<ViewStorage<T>&...> m_storages;
+        Tick m_since;
+
+        bool m_driver_packed = false;
+        std::span<const Entity> m_packed;
+        const EntitySet* m_set = nullptr;
+        size_t m_size_hint = 0;
+
+        template<size_t... I>
+        void select_driver(std::index_sequence<I...>) {
+            const std::array<size_t, sizeof...(T)> sizes { size_t(std::get<I>(m_storages).size())... };
+
+            size_t smallest = 0;
+            for (auto i = 1; i < sizes.size(); i++) {
+                if (sizes[i] < sizes[smallest]) smallest = i;
+            }
+            m_size_hint = sizes[smallest];
+
+            ((I == smallest ? use_driver(std::get<I>(m_storages)) : void()), ...);
+        }
+
+        template<typename S>
+        void use_driver(S& storage) {
+            if constexpr (PackedStorage<std::remove_const_t<S>>) {
+                m_driver_packed = true;
+                m_packed = storage.packed_entities();
+            } else {
+                m_driver_packed = false;
+                m_set = &storage.entities();
+            }
+        }
+
+        template<size_t... I>
+        inline bool contains(Entity e, std::index_sequence<I...>) const {
+            return (matches<T>(std::get<I>(m_storages), e) && ...);
+        }
+
+        template<typename Term, typename S>
+        inline bool matches(S& storage, Entity e) const {
+            if (!storage.contains(e)) return false;
+
+            constexpr auto filter = detail::ViewTerm<Term>::FILTER;
+            if constexpr (filter == detail::ViewFilter::CHANGED) return storage.ticks(e).changed_since(m_since);
+            else if constexpr (filter == detail::ViewFilter::ADDED) return storage.ticks(e).added_since(m_since);
+            else return true;
+        }
+
+        template<size_t... I>
+        void touch(std::index_sequence<I...>) {
+            ([this]() {
+                auto& storage = std::get<I>(m_storages);
+                if constexpr (!std::is_const_v<std::remove_reference_t<decltype(storage)>>) {
+                    if constexpr (ModifiedStorage<std::remove_cvref_t<decltype(storage)>>) storage.touch();
+                }
+            }(), ...);
+        }
+
+        template<size_t... I>
+        inline value_type get(Entity e, std::index_sequence<I...>) const {
+            return value_type(e, std::get<I>(m_storages)[e]...);
+        }
+    };
+
+}
@@ -1,31 +1,139 @@
 #pragma once
 
-#include <any>
+#include <filesystem>
 #include <memory>
-#include <queue>
-#include <typeindex>
-#include <typeinfo>
-#include <unordered_map>
+#include <ostream>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
+#include "Archetype.h"
+#include "CachedQuery.h"
+#include "ChangeTick.h"
 #include "Component.h"
 #include "Entity.h"
 #include "EntitySet.h"
+#include "EventChannel.h"
+#include "Observer.h"
+#include "Snapshot.h"
 #include "SystemGraph.h"
+#include "TypeId.h"
+#include "View.h"
+#include "ember/util/Profiling.h"
+#include "ember/util/ThreadPool.h"
+
+namespace ember::util {
+    class Logger;
+}
 
 namespace ember::ecs {
 
+    class CommandBuffer;
+
     class World {
     public:
         World();
         World(const SystemGraph& systems);
+        ~World();
 
+        // Run every system of the graph. Systems within a phase are independent so with
+        // a thread pool set they run concurrently, with a barrier between phases where
+        // the commands recorded during the phase are applied. Events published during
+        // a phase become readable in the next one.
         void run(float dt);
 
+        void set_thread_pool(std::shared_ptr<util::ThreadPool> pool);
+        inline util::ThreadPool* thread_pool() const { return m_thread_pool.get(); }
+
+        // Override the run policy a system declared, see RunPolicy. Throws if the
+        // system is not part of the graph.
+        void set_run_policy(SystemRunFn sys, RunPolicy policy);
+        RunPolicy run_policy(SystemRunFn sys) const;
+
+        // Slice of the system running on the calling thread, to spread its work over
+        // several runs under a time budget. Throws outside of a system.
+        TimeSlice& time_slice();
+
+        // Time every run, phase and system with the profiler. Off (null) by default.
+        void set_profiler(std::shared_ptr<util::Profiler> profiler);
+        inline util::Profiler* profiler() const { return m_profiler.get(); }
+
+        // Logger the systems of this world log to, whichever thread runs them. Null
+        // (the default) leaves them on the global logger.
+        void set_logger(std::shared_ptr<util::Logger> logger);
+        inline util::Logger* logger() const { return m_logger.get(); }
+
         Entity create_entity();
         void destroy_entity(Entity e);
 
+        // Create count entities into out, recycling destroyed ids first. Storages are
+        // grown once for the whole batch instead of once per entity.
+        void create_entities(size_t count, std::span<Entity> out);
+
+        // Remove the components of every entity from every storage, one pass per
+        // storage, and recycle their ids with the next generation. Entities that are
+        // no longer alive (without a TransformComponent) are skipped.
+        void destroy_entities(std::span<const Entity> entities);
+
+        // Binary snapshot of the entity allocator and of every component storage, which
+        // must all support snapshots (see Snapshot.h): saving throws std::logic_error
+        // otherwise. Loading replaces the contents of registered storages found in the
+        // snapshot and skips the others, so the components must be registered first.
+        void save_snapshot(std::ostream& out) const;
+        void save_snapshot(const std::filesystem::path& path) const;
+        // Replaces the contents of out, keeping its capacity
+        void save_snapshot(SnapshotBuffer& out) const;
+        void load_snapshot(std::span<const std::byte> data);
+        void load_snapshot(const std::filesystem::path& path);
+        // Load data, saved earlier from this world, over its current state: storages
+        // whose change ticks show no modification since the save are left alone,
+        // neither copied nor hooked. The change tick moves forward and the components
+        // of the reloaded storages are stamped changed at it, so change filters and
+        // deltas see the rollback.
+        void restore_snapshot(std::span<const std::byte> data);
+
+        // Allocate an entity id without touching any storage, safe to call from any thread
+        Entity reserve_entity();
+
+        // Command buffer of the calling thread. Structural changes made from systems
+        // running in parallel go through it and are applied at the next phase barrier.
+        CommandBuffer& commands();
+        void apply_commands();
+
         template<Component T>
-        void add_component() { add_resource<typename T::Storage>(); }
+        void add_component() {
+            using S = typename T::Storage;
+            add_resource<S>();
+
+            auto& slot = m_resources[type_id<S>()];
+            if constexpr (SnapshotStorage<S>) {
+                slot.type_hash = stable_type_hash<S>();
+                slot.save = [](const void* data, SnapshotWriter& writer) { static_cast<const S*>(data)->write_snapshot(writer); };
+                slot.load = [](void* data, SnapshotReader& reader) { static_cast<S*>(data)->read_snapshot(reader); };
+            }
+            slot.remove_entities = [](void* data, std::span<const Entity> entities) {
+                auto& storage = *static_cast<S*>(data);
+                if constexpr (requires { storage.remove_range(entities); }) {
+                    storage.remove_range(entities);
+                } else {
+                    for (const auto e : entities) {
+                        if (storage.contains(e)) storage.remove(e);
+                    }
+                }
+            };
+            if constexpr (requires(typename T::Storage& s) { s.bind(m_archetypes); }) {
+                write_component<T>().bind(m_archetypes);
+            }
+            if constexpr (ModifiedStorage<S>) {
+                write_component<T>().bind_ticks(m_change_tick);
+                slot.modified_tick = [](const void* data) { return static_cast<const S*>(data)->modified_tick(); };
+            }
+            if constexpr (TrackedStorage<S>) {
+                slot.mark_changed = [](void* data) { static_cast<S*>(data)->mark_all_changed(); };
+            }
+        }
 
         template<Component T>
         const typename T::Storage& read_component() const {
@@ -37,42 +145,212 @@ namespace ember::ecs {
             return write_resource<typename T::Storage>();
         }
 
+        template<Component T>
+        bool has_component() const {
+            return has_resource<typename T::Storage>();
+        }
+
         template<Component... T>
         EntitySet query() {
             return (read_component<T>().entities() & ...);
         }
 
+        // Persistent query kept up to date by storage hooks, created on first use and
+        // owned by the world. Cheaper than query() or view() when membership rarely changes.
+        template<typename... T>
+        CachedQuery<T...>& cached_query() {
+            using Query = CachedQuery<T...>;
+            const auto id = type_id<Query>();
+            if ((id >= m_resources.size()) || (m_resources[id].data == nullptr)) {
+                add_resource<Query>();
+                write_resource<Query>().attach(write_component<std::remove_const_t<T>>()...);
+            }
+            return write_resource<Query>();
+        }
+
+        // Non-allocating join over the storages of T..., see View. Components
+        // requested as const are read through the const storage. Changed and Added
+        // filters compare against the last run of the calling system.
+        template<typename... T>
+        View<T...> view() {
+            return View<T...>(last_run_tick(), view_storage<T>()...);
+        }
+
+        template<typename... T>
+        View<typename detail::ViewTerm<T>::ConstTerm...> view() const {
+            return View<typename detail::ViewTerm<T>::ConstTerm...>(
+                last_run_tick(),
+                read_component<std::remove_const_t<ViewComponent<T>>>()...
+            );
+        }
+
+        using ObserverId = size_t;
+
+        // Call fn with the inserts, replaces and removes of T, batched and delivered on
+        // the calling thread at every phase barrier once the commands of the phase are
+        // applied. Saves reacting systems from polling the whole storage each frame.
+        template<Component T>
+            requires HookedStorage<typename T::Storage>
+        ObserverId observe(ObserverFn fn) {
+            if (!has_component<T>()) add_component<T>();
+            const auto id = m_next_observer++;
+            m_observers.emplace_back(id, std::make_unique<ComponentObserver>(write_component<T>().hooks(), std::move(fn)));
+            return id;
+        }
+
+        // Must not be called from an observer callback
+        void remove_observer(ObserverId id);
+
+        // Deliver the changes queued so far, run() does it at every phase barrier
+        void deliver_observers();
+
+        // Current tick, advanced at the start of every phase
+        inline Tick change_tick() const { return m_change_tick; }
+        // Move the change tick forward so changes made from now on are newer than all
+        // the earlier ones, e.g. to tell them apart from a snapshot saved right after
+        inline void advance_change_tick() { m_change_tick++; }
+
+        // Tick at which the system running on the calling thread last ran (0 if it
+        // never ran or outside of a system), so changes newer than it are unseen
+        Tick last_run_tick() const;
+
+        inline ArchetypeRegistry& archetypes() { return m_archetypes; }
+        inline const ArchetypeRegistry& archetypes() const { return m_archetypes; }
+
+        // Event channel of type E, see EventChannel. Does nothing if it already exists.
+        template<typename E>
+        void add_events(size_t capacity = EventChannel<E>::DEFAULT_CAPACITY) {
+            using Channel = EventChannel<E>;
+            const auto id = type_id<Channel>();
+            if (id >= m_resources.size()) m_resources.resize(id + 1);
+
+            auto& slot = m_resources[id];
+            if (slot.data != nullptr) return;
+            slot.data = new Channel(capacity);
+            slot.destroy = [](void* data) { delete static_cast<Channel*>(data); };
+            slot.swap_events = [](void* data) { static_cast<Channel*>(data)->swap(); };
+            m_event_channels.push_back(id);
+        }
+
+        template<typename E>
+        EventChannel<E>& events() {
+            return write_resource<EventChannel<E>>();
+        }
+
+        template<typename E>
+        const EventChannel<E>& events() const {
+            return read_resource<EventChannel<E>>();
+        }
+
         template<typename T>
         void add_resource() {
-            const auto index = std::type_index(typeid(T));
-            m_components.insert({ index, std::any(T()) });
+            add_resource<T>(T());
         }
 
+        // Does nothing if a resource of type T already exists
         template<typename T>
         void add_resource(T resource) {
-            const auto index = std::type_index(typeid(T));
-            m_components.insert({ index, std::any(resource) });
+            const auto id = type_id<T>();
+            if (id >= m_resources.size()) m_resources.resize(id + 1);
+
+            auto& slot = m_resources[id];
+            if (slot.data != nullptr) return;
+            slot.data = new T(std::move(resource));
+            slot.destroy = [](void* data) { delete static_cast<T*>(data); };
+        }
+
+        template<typename T>
+        bool has_resource() const {
+            const auto id = type_id<T>();
+            return (id < m_resources.size()) && (m_resources[id].data != nullptr);
         }
 
         template<typename T>
         const T& read_resource() const {
-            const auto index = std::type_index(typeid(T));
-            return std::any_cast<const T&>(m_components.at(index));
+            return *static_cast<const T*>(resource(type_id<T>()));
         }
 
         template<typename T>
         T& write_resource() {
-            const auto index = std::type_index(typeid(T));
-            return std::any_cast<T&>(m_components.at(index));
+            return *static_cast<T*>(resource(type_id<T>()));
         }
 
     private:
+        // Type-erased resource owned by the world, indexed by its TypeId
+        struct ResourceSlot {
+            void* data = nullptr;
+            void (*destroy)(void*) = nullptr;
+            // Set for component storages only
+            void (*remove_entities)(void*, std::span<const Entity>) = nullptr;
+            // Set for component storages supporting snapshots only
+            uint64_t type_hash = 0;
+            void (*save)(const void*, SnapshotWriter&) = nullptr;
+            void (*load)(void*, SnapshotReader&) = nullptr;
+            // Set for component storages with change ticks only
+            Tick (*modified_tick)(const void*) = nullptr;
+            void (*mark_changed)(void*) = nullptr;
+            // Set for event channels only
+            void (*swap_events)(void*) = nullptr;
+        };
+
+        void check_snapshot_support() const;
+        void save_snapshot(SnapshotWriter& writer) const;
+        void load_snapshot(std::span<const std::byte> data, bool restore);
+
+        inline void* resource(TypeId id) const {
+            if ((id >= m_resources.size()) || (m_resources[id].data == nullptr)) {
+                throw std::out_of_range("Attempted to access missing resource!");
+            }
+            return m_resources[id].data;
+        }
+
+        template<typename T>
+        ViewStorage<T>& view_storage() {
+            using C = ViewComponent<T>;
+            if constexpr (std::is_const_v<C>) return read_component<std::remove_const_t<C>>();
+            else return write_component<C>();
+        }
+
+        void run_system(SystemRunFn sys, Tick& last_run, std::string_view name, RunSchedule& schedule);
+        // Phase and position within the phase of a system of the graph
+        std::pair<size_t, size_t> system_index(SystemRunFn sys) const;
+
+        std::mutex m_entity_mutex;
         Entity m_next_entity;
-        std::queue<Entity> m_recycled_entities;
+        // Destroyed ids with their next generation, reused from the back
+        std::vector<Entity> m_free_entities;
+
+        void allocate_entities(size_t count, Entity* out);
 
-        std::unordered_map<std::type_index, std::any> m_components;
+        // Slot 0 belongs to threads outside the pool, slot i+1 to worker i
+        std::vector<std::unique_ptr<CommandBuffer>> m_command_buffers;
+        std::vector<CommandBuffer*> m_command_buffer_list;
+
+        // Declared before the storages so it outlives any ArchetypeStorage bound to it
+        ArchetypeRegistry m_archetypes;
+        std::vector<ResourceSlot> m_resources;
+        // Swapped at the start of every run
+        std::vector<TypeId> m_event_channels;
+
+        // They unhook from their storage when destroyed, so the destructor clears
+        // them before any storage goes
+        std::vector<std::pair<ObserverId, std::unique_ptr<ComponentObserver>>> m_observers;
+        ObserverId m_next_observer = 0;
 
         SystemGraph m_systems;
+        // Last run tick of every system, laid out like m_systems
+        std::vector<std::vector<Tick>> m_system_ticks;
+        // Names used when profiling, laid out like m_systems
+        std::vector<std::vector<std::string_view>> m_system_names;
+        std::vector<std::vector<RunSchedule>> m_system_schedules;
+        // Number of run() calls so far, the frame index of frame based policies
+        uint64_t m_run_count = 0;
+        std::vector<std::string_view> m_phase_names;
+        Tick m_change_tick = 1;
+
+        std::shared_ptr<util::ThreadPool> m_thread_pool;
+        std::shared_ptr<util::Profiler> m_profiler;
+        std::shared_ptr<util::Logger> m_logger;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "World.h"
+#include "ember/util/ThreadPool.h"
+
+namespace ember::ecs {
+
+    // Steps many independent worlds (server shards, batched rollouts, ...) on one
+    // shared thread pool instead of one process or loop per world. Worlds advance in
+    // lockstep: a step runs every world exactly once, so none of them can starve the
+    // others, and the worlds that took longest last time start first to keep the end
+    // of the step short. Each world also gets the pool for its own phases.
+    //
+    // Worlds do not share mutable state through the engine: give each one its own
+    // logger (World::set_logger) and profiler if their output must stay apart.
+    class WorldPool {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using WorldId = uint32_t;
+
+        // Wall time of the runs of one world, not counting other worlds that ran nested
+        // on the same thread while it waited on its phases
+        struct Stats {
+            uint64_t runs = 0;
+            Clock::duration last = Clock::duration::zero();
+            // Exponential moving average over the last few runs
+            Clock::duration average = Clock::duration::zero();
+            Clock::duration total = Clock::duration::zero();
+        };
+
+        // Runs the worlds on the calling thread when pool is null
+        explicit WorldPool(std::shared_ptr<util::ThreadPool> pool);
+
+        WorldPool(const WorldPool&) = delete;
+        WorldPool& operator=(const WorldPool&) = delete;
+
+        WorldId add(std::shared_ptr<World> world);
+        void remove(WorldId id);
+
+        World& world(WorldId id);
+        const Stats& stats(WorldId id) const;
+        inline size_t size() const { return m_entries.size(); }
+
+        // Run every world once with dt, steps times. Waits for the whole step before
+        // the next one and rethrows the first exception of any world once it is over.
+        void run(float dt, size_t steps = 1);
+
+        inline util::ThreadPool* thread_pool() const { return m_pool.get(); }
+
+    private:
+        struct Entry {
+            WorldId id;
+            std::shared_ptr<World> world;
+            Stats stats;
+        };
+
+        std::shared_ptr<util::ThreadPool> m_pool;
+        std::vector<Entry> m_entries;
+        // Indices into m_entries ordered by descending average cost
+        std::vector<size_t> m_order;
+        WorldId m_next_id = 0;
+
+        Entry& entry(WorldId id);
+        const Entry& entry(WorldId id) const;
+        void run_step(float dt);
+    };
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Entity.h"
+
+namespace ember::ecs::bench {
+
+    static constexpr size_t DEFAULT_MAX_ENTITIES = 1'000'000;
+
+    // Entity counts every scaling benchmark runs at: powers of ten from 1k up to
+    // EMBER_BENCH_MAX_ENTITIES (1M unless set, 10M for the full sweep)
+    inline std::vector<size_t> entity_counts() {
+        auto max = DEFAULT_MAX_ENTITIES;
+        if (const auto* env = std::getenv("EMBER_BENCH_MAX_ENTITIES")) {
+            max = std::strtoull(env, nullptr, 10);
+        }
+
+        std::vector<size_t> counts;
+        for (size_t count = 1000; count <= max; count *= 10) {
+            counts.push_back(count);
+        }
+        if (counts.empty()) counts.push_back(1000);
+        return counts;
+    }
+
+    inline std::string bench_name(std::string_view name, size_t count) {
+        return std::string(name) + " [" + std::to_string(count) + "]";
+    }
+
+    // Deterministic shuffle of 0..count-1 so runs are comparable
+    inline std::vector<Entity> shuffled_entities(size_t count) {
+        std::vector<Entity> entities;
+        entities.reserve(count);
+        for (size_t i = 0; i < count; i++) entities.push_back(Entity(uint32_t(i)));
+
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (size_t i = count; i > 1; i--) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            std::swap(entities[i - 1], entities[state % i]);
+        }
+        return entities;
+    }
+
+}
@@ -0,0 +1,46 @@
+#include <sstream>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include "BenchUtils.h"
+#include "EntitySet.h"
+
+using namespace ember::ecs;
+using namespace ember::ecs::bench;
+
+namespace {
+    // Random subset of the first count entities, reproducible from the seed
+    EntitySet set_with_density(size_t count, double density, uint64_t seed) {
+        EntitySet set(count);
+        uint64_t state = seed;
+        for (size_t i = 0; i < count; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            if (double(state % 1'000'000) < density * 1'000'000) set.insert(Entity(uint32_t(i)));
+        }
+        return set;
+    }
+}
+
+TEST_CASE("EntitySet intersection benchmarks", "[EntitySet]") {
+    const auto count = GENERATE(from_range(entity_counts()));
+    const auto percent = GENERATE(0.1, 1.0, 10.0, 50.0, 100.0);
+
+    const auto set_a = set_with_density(count, percent / 100.0, 0x2545F4914F6CDD1DULL);
+    const auto set_b = set_with_density(count, percent / 100.0, 0x9E3779B97F4A7C15ULL);
+    std::ostringstream density;
+    density << percent << "%";
+
+    BENCHMARK(bench_name("intersect " + density.str(), count)) {
+        return set_a & set_b;
+    };
+
+    BENCHMARK(bench_name("iterate " + density.str(), count)) {
+        size_t n = 0;
+        for (const auto e : set_a) n += e.id;
+        return n;
+    };
+}
@@ -0,0 +1,77 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include "Archetype.h"
+#include "BenchUtils.h"
+#include "Storage.h"
+
+using namespace ember::ecs;
+using namespace ember::ecs::bench;
+
+namespace {
+    struct BenchComponent {
+        float x, y, z;
+    };
+
+    template<typename S>
+    S filled_storage(const std::vector<Entity>& entities) {
+        S storage;
+        for (const auto e : entities) storage.insert(e, { float(e.id), 0.0f, 0.0f });
+        return storage;
+    }
+}
+
+TEMPLATE_TEST_CASE("Storage insert benchmarks", "[Storage]", VectorStorage<BenchComponent>, DenseVectorStorage<BenchComponent>, MapStorage<BenchComponent>, ArchetypeStorage<BenchComponent>) {
+    const auto count = GENERATE(from_range(entity_counts()));
+    const auto entities = shuffled_entities(count);
+
+    BENCHMARK_ADVANCED(bench_name("insert", count))(Catch::Benchmark::Chronometer meter) {
+        std::vector<TestType> storages(meter.runs());
+        meter.measure([&](int run) {
+            auto& storage = storages[run];
+            for (const auto e : entities) storage.insert(e, { 1.0f, 2.0f, 3.0f });
+            return storage.size();
+        });
+    };
+}
+
+TEMPLATE_TEST_CASE("Storage remove benchmarks", "[Storage]", VectorStorage<BenchComponent>, DenseVectorStorage<BenchComponent>, MapStorage<BenchComponent>, ArchetypeStorage<BenchComponent>) {
+    const auto count = GENERATE(from_range(entity_counts()));
+    const auto entities = shuffled_entities(count);
+
+    BENCHMARK_ADVANCED(bench_name("remove", count))(Catch::Benchmark::Chronometer meter) {
+        std::vector<TestType> storages;
+        for (auto i = 0; i < meter.runs(); i++) storages.push_back(filled_storage<TestType>(entities));
+        meter.measure([&](int run) {
+            auto& storage = storages[run];
+            for (const auto e : entities) storage.remove(e);
+            return storage.size();
+        });
+    };
+}
+
+TEMPLATE_TEST_CASE("Storage iterate benchmarks", "[Storage]", VectorStorage<BenchComponent>, DenseVectorStorage<BenchComponent>, MapStorage<BenchComponent>, ArchetypeStorage<BenchComponent>) {
+    const auto count = GENERATE(from_range(entity_counts()));
+    const auto storage = filled_storage<TestType>(shuffled_entities(count));
+
+    BENCHMARK(bench_name("iterate entities", count)) {
+        auto sum = 0.0f;
+        for (const auto e : storage.entities()) sum += storage[e].x;
+        return sum;
+    };
+
+    if constexpr (requires { storage.packed_components(); }) {
+        BENCHMARK(bench_name("iterate packed", count)) {
+            auto sum = 0.0f;
+            for (const auto& c : storage.packed_components()) sum += c.x;
+            return sum;
+        };
+    }
+
+    BENCHMARK(bench_name("random access", count)) {
+        auto sum = 0.0f;
+        for (uint32_t id = 0; id < count; id += 7) sum += storage[Entity(id)].x;
+        return sum;
+    };
+}
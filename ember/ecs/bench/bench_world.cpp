@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+
+#include "BenchUtils.h"
+#include "CommandBuffer.h"
+#include "Parallel.h"
+#include "Rollback.h"
+#include "Storage.h"
+#include "SystemGraph.h"
+#include "World.h"
+
+using namespace ember::ecs;
+using namespace ember::ecs::bench;
+
+namespace {
+    struct Position {
+        using Storage = VectorStorage<Position>;
+        glm::vec3 value;
+    };
+    struct Velocity {
+        using Storage = VectorStorage<Velocity>;
+        glm::vec3 value;
+    };
+    struct Health {
+        using Storage = DenseVectorStorage<Health>;
+        float value;
+    };
+    struct Lifetime {
+        using Storage = DenseVectorStorage<Lifetime>;
+        float remaining;
+    };
+    struct Tag {
+        using Storage = MapStorage<Tag>;
+        uint32_t value;
+    };
+
+    // Every entity gets a Position, the other components are spread so queries
+    // of more components match fewer entities
+    void populate(World& world, size_t count) {
+        world.add_component<Position>();
+        world.add_component<Velocity>();
+        world.add_component<Health>();
+        world.add_component<Lifetime>();
+        world.add_component<Tag>();
+
+        std::vector<Entity> entities(count);
+        world.create_entities(count, entities);
+        for (size_t i = 0; i < count; i++) {
+            const auto e = entities[i];
+            world.write_component<Position>().insert(e, { glm::vec3(float(i), 0.0f, 0.0f) });
+            if (i % 2 == 0) world.write_component<Velocity>().insert(e, { glm::vec3(1.0f, 0.0f, 0.0f) });
+            if (i % 3 == 0) world.write_component<Health>().insert(e, { 100.0f });
+            if (i % 4 == 0) world.write_component<Lifetime>().insert(e, { float(i % 97) });
+            if (i % 5 == 0) world.write_component<Tag>().insert(e, { uint32_t(i) });
+        }
+    }
+
+    struct MovementSystem {
+        using Access = ember::ecs::Access<Read<Velocity>, Write<Position>>;
+        static void init(World&) { }
+        static void run(World& world, float dt) {
+            parallel_for_each(world.thread_pool(), world.view<Position, const Velocity>(), [dt](Entity, Position& p, const Velocity& v) {
+                p.value = p.value + v.value * dt;
+            });
+        }
+    };
+
+    struct DecaySystem {
+        using Access = ember::ecs::Access<Write<Health>>;
+        static void init(World&) { }
+        static void run(World& world, float dt) {
+            parallel_for_each(world.thread_pool(), world.view<Health>(), [dt](Entity, Health& h) {
+                h.value = std::max(0.0f, h.value - dt);
+            });
+        }
+    };
+
+    // Despawns expired entities and spawns replacements through the command buffers,
+    // keeping the entity count steady while exercising structural changes
+    struct LifetimeSystem {
+        using Access = ember::ecs::Access<Write<Lifetime>>;
+        static void init(World&) { }
+        static void run(World& world, float dt) {
+            parallel_for_each(world.thread_pool(), world.view<Lifetime>(), [&world, dt](Entity e, Lifetime& l) {
+                l.remaining -= dt;
+                if (l.remaining > 0.0f) return;
+
+                auto& commands = world.commands();
+                commands.destroy_entity(e);
+                const auto spawned = commands.create_entity();
+                commands.insert(spawned, Position { glm::vec3(0.0f) });
+                commands.insert(spawned, Lifetime { 96.0f });
+            });
+        }
+    };
+}
+
+TEST_CASE("World::query benchmarks", "[World]") {
+    const auto count = GENERATE(from_range(entity_counts()));
+    World world;
+    populate(world, count);
+
+    BENCHMARK(bench_name("query 2 components", count)) {
+        return world.query<Position, Velocity>();
+    };
+    BENCHMARK(bench_name("query 3 components", count)) {
+        return world.query<Position, Velocity, Health>();
+    };
+    BENCHMARK(bench_name("query 4 components", count)) {
+        return world.query<Position, Velocity, Health, Lifetime>();
+    };
+    BENCHMARK(bench_name("query 5 components", count)) {
+        return world.query<Position, Velocity, Health, Lifetime, Tag>();
+    };
+
+    // The components are summed so the view reads them and the loop is not optimized away
+    BENCHMARK(bench_name("view 2 components", count)) {
+        float sum = 0.0f;
+        for (const auto& [e, p, v] : world.view<const Position, const Velocity>()) sum += p.value.x + v.value.x;
+        return sum;
+    };
+    BENCHMARK(bench_name("view 5 components", count)) {
+        float sum = 0.0f;
+        for (const auto& [e, p, v, h, l, t] : world.view<const Position, const Velocity, const Health, const Lifetime, const Tag>()) {
+            sum += p.value.x + v.value.x + h.value + l.remaining + float(t.value);
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("World entity churn benchmarks", "[World]") {
+    const auto count = GENERATE(from_range(entity_counts()));
+    World world;
+    world.add_component<Position>();
+
+    std::vector<Entity> entities(count);
+    BENCHMARK(bench_name("create and destroy", count)) {
+        world.create_entities(count, entities);
+        world.destroy_entities(entities);
+        return entities.back();
+    };
+
+    BENCHMARK(bench_name("create and destroy one at a time", count)) {
+        for (size_t i = 0; i < count; i++) {
+            const auto e = world.create_entity();
+            world.write_component<Position>().insert(e, { glm::vec3(0.0f) });
+            entities[i] = e;
+        }
+        for (const auto e : entities) world.destroy_entity(e);
+        return entities.back();
+    };
+}
+
+TEST_CASE("World::run benchmarks", "[World]") {
+    const auto count = GENERATE(from_range(entity_counts()));
+
+    SystemGraphBuilder builder;
+    builder.add_system<MovementSystem>();
+    builder.add_system<DecaySystem>();
+    builder.add_system<LifetimeSystem>();
+
+    World world(builder.build());
+    populate(world, count);
+
+    BENCHMARK(bench_name("run single threaded", count)) {
+        world.run(1.0f / 60.0f);
+    };
+
+    world.set_thread_pool(std::make_shared<ember::util::ThreadPool>());
+    BENCHMARK(bench_name("run thread pool", count)) {
+        world.run(1.0f / 60.0f);
+    };
+}
+
+TEST_CASE("RollbackBuffer benchmarks", "[World]") {
+    // Rollback netcode is aimed at worlds of about 50k entities
+    auto counts = entity_counts();
+    counts.push_back(50000);
+    std::sort(counts.begin(), counts.end());
+    const auto count = GENERATE_REF(from_range(counts));
+    World world;
+    populate(world, count);
+
+    RollbackBuffer rollback(8);
+    uint64_t frame = 0;
+    BENCHMARK(bench_name("save", count)) {
+        rollback.save(world, frame++);
+    };
+
+    // One storage changed since the restored frame. Restoring stamps it changed again,
+    // so every iteration reloads it.
+    rollback.save(world, frame);
+    for (auto& velocity : world.write_component<Velocity>()) velocity.value.x += 1.0f;
+    BENCHMARK(bench_name("restore", count)) {
+        rollback.restore(world, frame);
+    };
+}
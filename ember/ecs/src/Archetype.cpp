@@ -0,0 +1,211 @@
+#include "Archetype.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace ember::ecs {
+
+    namespace {
+        constexpr size_t align_up(size_t value, size_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        size_t chunk_bytes(size_t capacity, const std::vector<size_t>& column_sizes) {
+            auto bytes = capacity * sizeof(Entity);
+            for (const auto size : column_sizes) {
+                bytes = align_up(bytes, Archetype::COLUMN_ALIGNMENT) + capacity * size;
+            }
+            return bytes;
+        }
+    }
+
+    Archetype::Archetype(std::vector<ColumnId> columns, const std::vector<ColumnInfo>& column_info):
+        m_columns(std::move(columns)), m_size(0)
+    {
+        size_t row_size = sizeof(Entity);
+        for (const auto column : m_columns) {
+            m_column_sizes.push_back(column_info.at(column).size);
+            row_size += column_info.at(column).size;
+        }
+
+        // Start from the unpadded estimate and back off until the aligned layout fits
+        m_capacity = CHUNK_SIZE / row_size;
+        while ((m_capacity > 1) && (chunk_bytes(m_capacity, m_column_sizes) > CHUNK_SIZE)) m_capacity--;
+        if (chunk_bytes(m_capacity, m_column_sizes) > CHUNK_SIZE) {
+            throw std::length_error("Archetype row does not fit in a single chunk");
+        }
+
+        auto offset = m_capacity * sizeof(Entity);
+        for (const auto size : m_column_sizes) {
+            offset = align_up(offset, COLUMN_ALIGNMENT);
+            m_column_offsets.push_back(offset);
+            offset += m_capacity * size;
+        }
+    }
+
+    int Archetype::column_index(ColumnId column) const {
+        const auto iter = std::lower_bound(m_columns.begin(), m_columns.end(), column);
+        if ((iter == m_columns.end()) || (*iter != column)) return -1;
+        return int(iter - m_columns.begin());
+    }
+
+    std::byte* Archetype::get(size_t row, size_t index) {
+        return column_data(row / m_capacity, index) + (row % m_capacity) * m_column_sizes[index];
+    }
+
+    const std::byte* Archetype::get(size_t row, size_t index) const {
+        return column_data(row / m_capacity, index) + (row % m_capacity) * m_column_sizes[index];
+    }
+
+    size_t Archetype::push(Entity e) {
+        const auto row = m_size;
+        if ((row / m_capacity) >= m_chunks.size()) {
+            m_chunks.push_back(std::make_unique<Chunk>());
+        }
+
+        entities(row / m_capacity)[row % m_capacity] = e;
+        m_size++;
+        return row;
+    }
+
+    Entity Archetype::swap_remove(size_t row) {
+        assert(row < m_size);
+
+        const auto last = m_size - 1;
+        Entity moved = INVALID_ENTITY;
+        if (row != last) {
+            moved = entity(last);
+            entities(row / m_capacity)[row % m_capacity] = moved;
+            for (auto i = 0; i < m_columns.size(); i++) {
+                std::memcpy(get(row, i), get(last, i), m_column_sizes[i]);
+            }
+        }
+        m_size--;
+
+        // Keep one spare chunk around so an entity bouncing across a chunk
+        // boundary does not allocate every frame.
+        while ((m_chunks.size() * m_capacity) >= (m_size + 2 * m_capacity)) {
+            m_chunks.pop_back();
+        }
+
+        return moved;
+    }
+
+    ArchetypeRegistry::ArchetypeRegistry() {
+        // Archetype 0 is the empty archetype and the root of the archetype graph
+        find_or_create_archetype({});
+    }
+
+    ArchetypeRegistry::Location& ArchetypeRegistry::location(Entity e) {
+        if (e.id >= m_locations.size()) m_locations.resize(e.id + 1);
+        return m_locations[e.id];
+    }
+
+    bool ArchetypeRegistry::contains(Entity e, ColumnId column) const {
+        if (e.id >= m_locations.size()) return false;
+        const auto& loc = m_locations[e.id];
+        return (loc.archetype != NO_ARCHETYPE) && m_archetypes[loc.archetype].has_column(column);
+    }
+
+    std::byte* ArchetypeRegistry::get(Entity e, ColumnId column) {
+        const auto& loc = m_locations.at(e.id);
+        auto& archetype = m_archetypes.at(loc.archetype);
+        return archetype.get(loc.row, archetype.column_index(column));
+    }
+
+    const std::byte* ArchetypeRegistry::get(Entity e, ColumnId column) const {
+        const auto& loc = m_locations.at(e.id);
+        const auto& archetype = m_archetypes.at(loc.archetype);
+        return archetype.get(loc.row, archetype.column_index(column));
+    }
+
+    void ArchetypeRegistry::insert(Entity e, ColumnId column, const void* data) {
+        const auto& loc = location(e);
+        const auto from = (loc.archetype == NO_ARCHETYPE) ? 0 : loc.archetype;
+        const auto to = archetype_with(from, column);
+        move_entity(e, to);
+
+        auto& archetype = m_archetypes[to];
+        const auto index = archetype.column_index(column);
+        std::memcpy(archetype.get(m_locations[e.id].row, index), data, m_column_info[column].size);
+    }
+
+    void ArchetypeRegistry::remove(Entity e, ColumnId column) {
+        if (!contains(e, column)) throw std::out_of_range("Attempted to remove invalid component!");
+
+        const auto to = archetype_without(m_locations[e.id].archetype, column);
+        move_entity(e, to);
+    }
+
+    size_t ArchetypeRegistry::find_or_create_archetype(std::vector<ColumnId> columns) {
+        const auto iter = m_archetype_index.find(columns);
+        if (iter != m_archetype_index.end()) return iter->second;
+
+        const auto index = m_archetypes.size();
+        m_archetypes.emplace_back(columns, m_column_info);
+        m_archetype_index.insert({ std::move(columns), index });
+        return index;
+    }
+
+    size_t ArchetypeRegistry::archetype_with(size_t from, ColumnId column) {
+        if (m_archetypes[from].has_column(column)) return from;
+
+        const auto edge = m_archetypes[from].add_edges.find(column);
+        if (edge != m_archetypes[from].add_edges.end()) return edge->second;
+
+        auto columns = m_archetypes[from].columns();
+        columns.insert(std::lower_bound(columns.begin(), columns.end(), column), column);
+        const auto to = find_or_create_archetype(std::move(columns));
+
+        // find_or_create_archetype may reallocate m_archetypes so index again
+        m_archetypes[from].add_edges.insert({ column, to });
+        m_archetypes[to].remove_edges.insert({ column, from });
+        return to;
+    }
+
+    size_t ArchetypeRegistry::archetype_without(size_t from, ColumnId column) {
+        const auto edge = m_archetypes[from].remove_edges.find(column);
+        if (edge != m_archetypes[from].remove_edges.end()) return edge->second;
+
+        auto columns = m_archetypes[from].columns();
+        columns.erase(std::find(columns.begin(), columns.end(), column));
+        const auto to = find_or_create_archetype(std::move(columns));
+
+        m_archetypes[from].remove_edges.insert({ column, to });
+        m_archetypes[to].add_edges.insert({ column, from });
+        return to;
+    }
+
+    void ArchetypeRegistry::move_entity(Entity e, size_t to) {
+        auto& loc = location(e);
+        if (loc.archetype == to) return;
+
+        // Entities without any archetype components are not stored at all
+        // so the empty archetype never holds rows.
+        auto row = size_t(0);
+        if (to != 0) {
+            auto& dst = m_archetypes[to];
+            row = dst.push(e);
+
+            if (loc.archetype != NO_ARCHETYPE) {
+                const auto& src = m_archetypes[loc.archetype];
+                for (auto i = 0; i < src.columns().size(); i++) {
+                    const auto index = dst.column_index(src.columns()[i]);
+                    if (index >= 0) {
+                        std::memcpy(dst.get(row, index), src.get(loc.row, i), m_column_info[src.columns()[i]].size);
+                    }
+                }
+            }
+        }
+
+        if (loc.archetype != NO_ARCHETYPE) {
+            const auto moved = m_archetypes[loc.archetype].swap_remove(loc.row);
+            if (moved != INVALID_ENTITY) m_locations[moved.id].row = loc.row;
+        }
+
+        loc.archetype = (to != 0) ? uint32_t(to) : NO_ARCHETYPE;
+        loc.row = uint32_t(row);
+    }
+
+}
@@ -0,0 +1,26 @@
+#include "CommandBuffer.h"
+
+namespace ember::ecs {
+
+    bool CommandBuffer::empty() const {
+        if (!m_destroyed.empty()) return false;
+        return std::all_of(m_queues.begin(), m_queues.end(), [](const auto& queue) { return !queue || queue->empty(); });
+    }
+
+    void CommandBuffer::apply(World& world, std::span<CommandBuffer* const> buffers) {
+        // Each queue pulls in the queues of the same storage from the other
+        // buffers, so every storage is visited once no matter the thread count
+        for (auto* buffer : buffers) {
+            for (auto& queue : buffer->m_queues) {
+                if (queue && !queue->empty()) queue->apply(world, buffers);
+            }
+        }
+
+        for (auto* buffer : buffers) {
+            if (buffer->m_destroyed.empty()) continue;
+            world.destroy_entities(buffer->m_destroyed);
+            buffer->m_destroyed.clear();
+        }
+    }
+
+}
@@ -0,0 +1,83 @@
+#include "Delta.h"
+
+namespace ember::ecs {
+
+    void DeltaWriter::write_varint(uint64_t value) {
+        while (value >= 0x80) {
+            write_byte(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        write_byte(uint8_t(value));
+    }
+
+    void DeltaWriter::write_bytes(std::span<const std::byte> bytes) {
+        m_out->insert(m_out->end(), bytes.begin(), bytes.end());
+    }
+
+    uint8_t DeltaReader::read_byte() {
+        if (done()) throw std::runtime_error("Delta ended unexpectedly!");
+        return uint8_t(m_data[m_offset++]);
+    }
+
+    uint64_t DeltaReader::read_varint() {
+        uint64_t value = 0;
+        for (auto shift = 0; shift < 64; shift += 7) {
+            const auto byte = read_byte();
+            value |= uint64_t(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw std::runtime_error("Delta has an invalid varint!");
+    }
+
+    std::span<const std::byte> DeltaReader::read_bytes(size_t size) {
+        if (size > m_data.size() - m_offset) throw std::runtime_error("Delta ended unexpectedly!");
+        const auto bytes = m_data.subspan(m_offset, size);
+        m_offset += size;
+        return bytes;
+    }
+
+    void DeltaEncoder::encode(const World& world, std::vector<std::byte>& out) {
+        DeltaWriter writer(out);
+        writer.write_byte(DELTA_VERSION);
+
+        for (const auto& channel : m_channels) {
+            m_scratch.clear();
+            DeltaWriter entries(m_scratch);
+            channel->encode(world, m_since, entries);
+            if (m_scratch.empty()) continue;
+
+            // Little-endian whatever the machine
+            for (auto i = 0; i < 8; i++) writer.write_byte(uint8_t(channel->type_hash >> (8 * i)));
+            writer.write_varint(m_scratch.size());
+            writer.write_bytes(m_scratch);
+        }
+        m_since = world.change_tick();
+    }
+
+    void DeltaEncoder::reset() {
+        for (const auto& channel : m_channels) channel->reset();
+        m_since = 0;
+    }
+
+    void DeltaDecoder::apply(World& world, std::span<const std::byte> delta) {
+        DeltaReader reader(delta);
+        if (reader.read_byte() != DELTA_VERSION) throw std::runtime_error("Unsupported delta version!");
+
+        while (!reader.done()) {
+            uint64_t hash = 0;
+            for (auto i = 0; i < 8; i++) hash |= uint64_t(reader.read_byte()) << (8 * i);
+            const auto size = reader.read_varint();
+            DeltaReader entries(reader.read_bytes(size));
+
+            const auto channel = std::find_if(m_channels.begin(), m_channels.end(), [hash](const auto& channel) {
+                return channel->type_hash == hash;
+            });
+            if (channel != m_channels.end()) (*channel)->decode(world, entries);
+        }
+    }
+
+    void DeltaDecoder::reset() {
+        for (const auto& channel : m_channels) channel->reset();
+    }
+
+}
@@ -1,6 +1,8 @@
 #include "EntitySet.h"
 
 #include <cassert>
+#include <span>
+#include <stdexcept>
 
 namespace ember::ecs {
     void EntitySet::insert(Entity e) {
@@ -17,6 +19,23 @@ namespace ember::ecs {
         m_ids.reset(e.id);
     }
 
+    void EntitySet::write_snapshot(SnapshotWriter& writer) const {
+        writer.write_value(uint64_t(m_ids.size()));
+        writer.write_block(std::span<const uint64_t>(m_ids.data()));
+        writer.write_block(std::span<const uint32_t>(m_generations));
+    }
+
+    void EntitySet::read_snapshot(SnapshotReader& reader) {
+        const auto size = reader.read_value<uint64_t>();
+        const auto words = reader.read_block<uint64_t>();
+        if (words.size() != (size + 63) / 64) throw std::runtime_error("Snapshot EntitySet has an invalid size!");
+
+        m_ids.resize(size);
+        std::copy(words.begin(), words.end(), m_ids.data().begin());
+        reader.read_into(m_generations);
+        if (m_generations.size() != size) throw std::runtime_error("Snapshot EntitySet has an invalid size!");
+    }
+
     // For sparse sets doing it this way is ~25x speedup so it might be ugly
     // but speed is speed.
     namespace {
@@ -0,0 +1,72 @@
+#include "Rollback.h"
+
+#include <stdexcept>
+
+namespace ember::ecs {
+
+    RollbackBuffer::RollbackBuffer(size_t capacity): m_slots(capacity) {
+        if (capacity == 0) throw std::invalid_argument("RollbackBuffer requires at least one slot");
+    }
+
+    size_t RollbackBuffer::count_before(uint64_t frame) const {
+        // Frames increase around the ring, so binary search it
+        size_t low = 0;
+        size_t high = m_size;
+        while (low < high) {
+            const auto mid = low + (high - low) / 2;
+            if (slot(mid).frame < frame) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+
+    void RollbackBuffer::save(World& world, uint64_t frame) {
+        auto first = m_first;
+        auto size = count_before(frame);
+        if (size == m_slots.size()) {
+            first = (first + 1) % m_slots.size();
+            size--;
+        }
+
+        // Storages modified at the tick of the snapshot are reloaded when restoring it,
+        // so changes made before saving get an older tick than the snapshot. Saving
+        // throws before writing anything, leaving the ring as it was.
+        auto& target = m_slots[(first + size) % m_slots.size()];
+        world.advance_change_tick();
+        world.save_snapshot(target.data);
+        target.frame = frame;
+        m_first = first;
+        m_size = size + 1;
+    }
+
+    bool RollbackBuffer::contains(uint64_t frame) const {
+        const auto index = count_before(frame);
+        return (index < m_size) && (slot(index).frame == frame);
+    }
+
+    void RollbackBuffer::restore(World& world, uint64_t frame) {
+        const auto index = count_before(frame);
+        if ((index == m_size) || (slot(index).frame != frame)) {
+            throw std::out_of_range("Attempted to restore missing frame!");
+        }
+
+        world.restore_snapshot(slot(index).data);
+        m_size = index + 1;
+    }
+
+    uint64_t RollbackBuffer::oldest() const {
+        if (empty()) throw std::out_of_range("Attempted to access frame of empty RollbackBuffer!");
+        return slot(0).frame;
+    }
+
+    uint64_t RollbackBuffer::latest() const {
+        if (empty()) throw std::out_of_range("Attempted to access frame of empty RollbackBuffer!");
+        return slot(m_size - 1).frame;
+    }
+
+    void RollbackBuffer::clear() {
+        m_first = 0;
+        m_size = 0;
+    }
+
+}
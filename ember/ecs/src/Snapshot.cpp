@@ -0,0 +1,87 @@
+#include "Snapshot.h"
+
+namespace ember::ecs {
+
+    namespace {
+        constexpr size_t align_up(size_t offset) {
+            return (offset + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1);
+        }
+    }
+
+    void SnapshotWriter::write_raw(const void* data, size_t size) {
+        if (m_buffer) {
+            const auto end = m_buffer->size();
+            m_buffer->resize(end + size);
+            if (size > 0) std::memcpy(m_buffer->data() + end, data, size);
+        } else {
+            m_out->write(static_cast<const char*>(data), std::streamsize(size));
+        }
+        m_offset += size;
+    }
+
+    void SnapshotWriter::pad() {
+        static constexpr std::array<char, SNAPSHOT_ALIGNMENT> zeros {};
+        write_raw(zeros.data(), align_up(m_offset) - m_offset);
+    }
+
+    void SnapshotWriter::write_block(const void* data, size_t size) {
+        const auto size_field = uint64_t(size);
+        write_raw(&size_field, sizeof(size_field));
+        pad();
+        write_raw(data, size);
+        pad();
+
+        if (m_out && !*m_out) throw std::runtime_error("Failed to write snapshot!");
+    }
+
+    size_t SnapshotWriter::begin_record(uint64_t type_hash) {
+        const auto record = m_offset;
+        write_value(SnapshotRecord { type_hash, 0 });
+        return record;
+    }
+
+    void SnapshotWriter::end_record(size_t record) {
+        // Patch the size into the record block, whose data is on the boundary after its size field
+        const auto data_offset = align_up(record + sizeof(uint64_t));
+        const auto body_offset = align_up(data_offset + sizeof(SnapshotRecord));
+        const auto size = uint64_t(m_offset - body_offset);
+
+        if (m_buffer) {
+            std::memcpy(m_buffer->data() + m_buffer_start + data_offset + offsetof(SnapshotRecord, size), &size, sizeof(size));
+            return;
+        }
+
+        const auto end = m_out->tellp();
+        m_out->seekp(m_start + std::streamoff(data_offset + offsetof(SnapshotRecord, size)));
+        m_out->write(reinterpret_cast<const char*>(&size), sizeof(size));
+        m_out->seekp(end);
+        if (!*m_out) throw std::runtime_error("Failed to write snapshot!");
+    }
+
+    SnapshotReader::SnapshotReader(std::span<const std::byte> data): m_data(data) {
+        if (reinterpret_cast<uintptr_t>(data.data()) % SNAPSHOT_ALIGNMENT != 0) {
+            throw std::invalid_argument("Snapshot data must be aligned to SNAPSHOT_ALIGNMENT");
+        }
+    }
+
+    std::span<const std::byte> SnapshotReader::read_block() {
+        uint64_t size = 0;
+        if (m_offset + sizeof(size) > m_data.size()) throw std::runtime_error("Snapshot is truncated!");
+        std::memcpy(&size, m_data.data() + m_offset, sizeof(size));
+
+        const auto begin = align_up(m_offset + sizeof(size));
+        if ((begin > m_data.size()) || (size > m_data.size() - begin)) throw std::runtime_error("Snapshot is truncated!");
+
+        m_offset = align_up(begin + size);
+        return m_data.subspan(begin, size);
+    }
+
+    SnapshotReader SnapshotReader::sub_reader(size_t size) {
+        if (size > m_data.size() - std::min(m_offset, m_data.size())) throw std::runtime_error("Snapshot is truncated!");
+
+        auto reader = SnapshotReader(m_data.subspan(m_offset, size));
+        m_offset += size;
+        return reader;
+    }
+
+}
@@ -1,34 +1,98 @@
 #include "SystemGraph.h"
 
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
 namespace ember::ecs {
 
+    namespace {
+        struct SystemRegistry {
+            std::shared_mutex mutex;
+            std::unordered_map<SystemRunFn, std::string_view> names;
+            std::unordered_map<SystemRunFn, RunPolicy> policies;
+        };
+
+        SystemRegistry& system_registry() {
+            static SystemRegistry registry;
+            return registry;
+        }
+
+        bool intersects(const std::vector<TypeId>& lhs, const std::vector<TypeId>& rhs) {
+            return std::any_of(lhs.begin(), lhs.end(), [&](const auto& type) {
+                return std::find(rhs.begin(), rhs.end(), type) != rhs.end();
+            });
+        }
+    }
+
+    void detail::register_system_name(SystemRunFn sys, std::string_view name) {
+        auto& registry = system_registry();
+        std::unique_lock lock(registry.mutex);
+        registry.names.insert({ sys, name });
+    }
+
+    std::string_view system_name(SystemRunFn sys) {
+        auto& registry = system_registry();
+        std::shared_lock lock(registry.mutex);
+        const auto iter = registry.names.find(sys);
+        return (iter != registry.names.end()) ? iter->second : std::string_view();
+    }
+
+    void detail::register_system_policy(SystemRunFn sys, RunPolicy policy) {
+        auto& registry = system_registry();
+        std::unique_lock lock(registry.mutex);
+        registry.policies.insert({ sys, policy });
+    }
+
+    RunPolicy system_run_policy(SystemRunFn sys) {
+        auto& registry = system_registry();
+        std::shared_lock lock(registry.mutex);
+        const auto iter = registry.policies.find(sys);
+        return (iter != registry.policies.end()) ? iter->second : RunPolicy();
+    }
+
+    bool AccessInfo::conflicts_with(const AccessInfo& other) const {
+        // Without a declaration nothing is known about what the system touches
+        if (!declared || !other.declared) return true;
+
+        return intersects(writes, other.writes)
+            || intersects(writes, other.reads)
+            || intersects(reads, other.writes);
+    }
+
     SystemGraph SystemGraphBuilder::build() {
         SystemGraph graph;
 
-
-        std::set<SystemRunFn> remaining_systems = m_systems;
+        auto dependencies = m_dependencies;
+        auto remaining_systems = m_order;
         while (!remaining_systems.empty()) {
-            std::set<SystemRunFn> removal_set;
+            std::vector<SystemRunFn> deferred;
             auto& phase = graph.emplace_back();
 
-            for (const auto& [sys, edges] : m_dependencies) {
-                if (edges.empty()) {
-                    phase.insert(sys);
-                    remaining_systems.erase(sys);
-                    removal_set.insert(sys);
-                }
+            for (const auto sys : remaining_systems) {
+                const auto ready = dependencies.at(sys).empty();
+                const auto conflicts = std::any_of(phase.begin(), phase.end(), [&](const auto other) {
+                    return m_access.at(sys).conflicts_with(m_access.at(other));
+                });
+
+                if (ready && !conflicts) phase.insert(sys);
+                else deferred.push_back(sys);
             }
 
+            if (phase.empty()) throw std::logic_error("System ordering contains a cycle");
+
             for (auto sys : phase) {
-                for (auto& [s, edges] : m_dependencies) {
+                for (auto& [s, edges] : dependencies) {
                     edges.erase(sys);
                 }
             }
 
-            for (const auto sys : removal_set) m_dependencies.erase(sys);
+            remaining_systems = std::move(deferred);
         }
 
         return graph;
     }
 
-}
\ No newline at end of file
+}
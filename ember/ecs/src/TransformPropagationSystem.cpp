@@ -0,0 +1,235 @@
+#include "TransformPropagationSystem.h"
+
+#include <optional>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define EMBER_TRANSFORM_SSE 1
+#endif
+
+#include "Parallel.h"
+
+namespace ember::ecs {
+
+    void multiply_transforms(const glm::mat4& parent, const glm::mat4& local, glm::mat4& out) {
+#ifdef EMBER_TRANSFORM_SSE
+        // Column j of the result is the columns of parent weighted by column j of local
+        const auto* p = &parent[0][0];
+        const auto c0 = _mm_loadu_ps(p);
+        const auto c1 = _mm_loadu_ps(p + 4);
+        const auto c2 = _mm_loadu_ps(p + 8);
+        const auto c3 = _mm_loadu_ps(p + 12);
+
+        for (auto j = 0; j < 4; j++) {
+            const auto* l = &local[j][0];
+            auto column = _mm_mul_ps(c0, _mm_set1_ps(l[0]));
+            column = _mm_add_ps(column, _mm_mul_ps(c1, _mm_set1_ps(l[1])));
+            column = _mm_add_ps(column, _mm_mul_ps(c2, _mm_set1_ps(l[2])));
+            column = _mm_add_ps(column, _mm_mul_ps(c3, _mm_set1_ps(l[3])));
+            _mm_storeu_ps(&out[j][0], column);
+        }
+#else
+        out = parent * local;
+#endif
+    }
+
+    namespace {
+        // The entity of the set with the given id, whatever its generation
+        std::optional<Entity> entity_with_id(const EntitySet& set, uint32_t id) {
+            const auto iter = set.iter_from(id);
+            if ((iter == set.end()) || ((*iter).id != id)) return std::nullopt;
+            return *iter;
+        }
+    }
+
+    TransformHierarchy::~TransformHierarchy() {
+        if (!attached()) return;
+        m_transforms->hooks().remove_hook(m_hooks[0]);
+        m_transforms->hooks().remove_hook(m_hooks[1]);
+        m_parents->hooks().remove_hook(m_hooks[2]);
+        m_parents->hooks().remove_hook(m_hooks[3]);
+        m_parents->hooks().remove_hook(m_hooks[4]);
+    }
+
+    void TransformHierarchy::attach(TransformComponent::Storage& transforms, ParentComponent::Storage& parents) {
+        if (attached()) throw std::logic_error("TransformHierarchy is already attached");
+        m_transforms = &transforms;
+        m_parents = &parents;
+
+        const auto dirty = [this](Entity e) { mark_dirty(e.id); };
+        m_hooks[0] = transforms.hooks().on_insert(dirty);
+        m_hooks[1] = transforms.hooks().on_remove(dirty);
+        m_hooks[2] = parents.hooks().on_insert(dirty);
+        m_hooks[3] = parents.hooks().on_replace(dirty);
+        m_hooks[4] = parents.hooks().on_remove(dirty);
+        invalidate();
+    }
+
+    void TransformHierarchy::mark_dirty(uint32_t id) {
+        // Everything is revisited by the rebuild anyway
+        if (!m_stale) push_dirty(id);
+    }
+
+    void TransformHierarchy::push_dirty(uint32_t id) {
+        if (id >= m_is_dirty.size()) m_is_dirty.resize(id + 1, 0);
+        if (m_is_dirty[id]) return;
+        m_is_dirty[id] = 1;
+        m_dirty.push_back(id);
+    }
+
+    void TransformHierarchy::detach(uint32_t id) {
+        if ((id >= m_depth.size()) || (m_depth[id] == UNVISITED)) return;
+        const auto d = m_depth[id];
+
+        // The children have to find their new level too
+        if ((m_child_count[id] > 0) && (d + 1 < m_levels.size())) {
+            for (const auto& node : m_levels[d + 1]) {
+                if (node.parent.id == id) push_dirty(node.entity.id);
+            }
+        }
+
+        auto& level = m_levels[d];
+        const auto slot = m_slot[id];
+        if (level[slot].parent != INVALID_ENTITY) m_child_count[level[slot].parent.id]--;
+        level[slot] = level.back();
+        m_slot[level[slot].entity.id] = slot;
+        level.pop_back();
+        m_depth[id] = UNVISITED;
+    }
+
+    uint32_t TransformHierarchy::depth(
+        Entity e,
+        const TransformComponent::Storage& transforms,
+        const ParentComponent::Storage& parents,
+        GlobalTransformComponent::Storage& globals
+    ) {
+        if (m_depth[e.id] == VISITING) throw std::logic_error("Transform hierarchy contains a cycle");
+        if (m_depth[e.id] != UNVISITED) return m_depth[e.id];
+
+        // Parents without a transform (destroyed for example) make their children roots
+        m_depth[e.id] = VISITING;
+        auto parent = INVALID_ENTITY;
+        uint32_t d = 0;
+        if (parents.contains(e) && transforms.contains(parents[e].parent)) {
+            parent = parents[e].parent;
+            d = depth(parent, transforms, parents, globals) + 1;
+            m_child_count[parent.id]++;
+        }
+
+        if (d >= m_levels.size()) m_levels.resize(d + 1);
+        m_depth[e.id] = d;
+        m_slot[e.id] = uint32_t(m_levels[d].size());
+        m_levels[d].push_back(Node { e, parent });
+        m_moved[e.id] = 1;
+
+        if (!globals.contains(e)) globals.insert(e, {});
+        return d;
+    }
+
+    void TransformHierarchy::update(World& world) {
+        const auto& transforms = world.read_component<TransformComponent>();
+        const auto& parents = world.read_component<ParentComponent>();
+        auto& globals = world.write_component<GlobalTransformComponent>();
+
+        if (m_stale) {
+            m_levels.clear();
+            m_dirty.clear();
+            m_depth.assign(transforms.entities().size(), UNVISITED);
+            m_child_count.assign(transforms.entities().size(), 0);
+            m_is_dirty.assign(transforms.entities().size(), 0);
+            for (const auto e : transforms.entities()) push_dirty(e.id);
+            for (const auto e : globals.entities()) push_dirty(e.id);
+        } else if (m_dirty.empty()) {
+            return;
+        }
+
+        const auto size = std::max(transforms.entities().size(), m_is_dirty.size());
+        m_depth.resize(size, UNVISITED);
+        m_slot.resize(size, 0);
+        m_child_count.resize(size, 0);
+        m_moved.resize(size, 0);
+        m_updated.resize(size, 0);
+
+        // Detaching appends the children of each detached entity
+        for (auto i = 0; i < m_dirty.size(); i++) detach(m_dirty[i]);
+
+        // Global transforms follow the transforms, down to the generation
+        for (const auto id : m_dirty) {
+            const auto global = entity_with_id(globals.entities(), id);
+            if (!global) continue;
+            const auto e = entity_with_id(transforms.entities(), id);
+            if (!e || (e->generation != global->generation)) globals.remove(*global);
+        }
+
+        // Stays stale if a cycle throws half way through
+        m_stale = true;
+        for (const auto id : m_dirty) {
+            m_is_dirty[id] = 0;
+            if (const auto e = entity_with_id(transforms.entities(), id)) {
+                depth(*e, transforms, parents, globals);
+            }
+        }
+        m_dirty.clear();
+
+        while (!m_levels.empty() && m_levels.back().empty()) m_levels.pop_back();
+        m_stale = false;
+    }
+
+    void TransformHierarchy::propagate(World& world, Tick since) {
+        const auto& transforms = world.read_component<TransformComponent>();
+        auto& globals = world.write_component<GlobalTransformComponent>();
+        const auto& const_globals = globals;
+
+        for (auto l = 0; l < level_count(); l++) {
+            const auto nodes = level(l);
+            parallel_for(world.thread_pool(), nodes.size(), DEFAULT_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+                for (auto i = begin; i < end; i++) {
+                    const auto& node = nodes[i];
+                    const auto root = (node.parent == INVALID_ENTITY);
+                    const auto changed = m_moved[node.entity.id]
+                        || transforms.ticks(node.entity).changed_since(since)
+                        || (!root && m_updated[node.parent.id]);
+
+                    m_moved[node.entity.id] = 0;
+                    m_updated[node.entity.id] = changed;
+                    if (!changed) continue;
+
+                    const auto& local = transforms[node.entity].transform;
+                    if (root) {
+                        globals[node.entity].transform = local;
+                    } else {
+                        multiply_transforms(const_globals[node.parent].transform, local, globals[node.entity].transform);
+                    }
+                }
+            });
+        }
+    }
+
+    void TransformPropagationSystem::init(World& world) {
+        world.add_component<ParentComponent>();
+        world.add_component<GlobalTransformComponent>();
+        world.add_resource<TransformHierarchy>();
+        world.write_resource<TransformHierarchy>().attach(
+            world.write_component<TransformComponent>(),
+            world.write_component<ParentComponent>()
+        );
+    }
+
+    void TransformPropagationSystem::run(World& world, float) {
+        auto& hierarchy = world.write_resource<TransformHierarchy>();
+        const auto since = world.last_run_tick();
+
+        // Reparenting through mutable access to the parent component runs no hooks
+        const auto& parents = world.read_component<ParentComponent>();
+        const auto parent_entities = parents.packed_entities();
+        const auto parent_ticks = parents.packed_ticks();
+        for (auto i = 0; i < parent_ticks.size(); i++) {
+            if (parent_ticks[i].changed_since(since)) hierarchy.mark_dirty(parent_entities[i].id);
+        }
+
+        hierarchy.update(world);
+        hierarchy.propagate(world, since);
+    }
+
+}
@@ -0,0 +1,12 @@
+#include "TypeId.h"
+
+#include <atomic>
+
+namespace ember::ecs {
+
+    TypeId detail::next_type_id() {
+        static std::atomic<TypeId> s_next = 0;
+        return s_next.fetch_add(1);
+    }
+
+}
@@ -1,43 +1,352 @@
 #include "World.h"
 
+#include <algorithm>
+#include <fstream>
 #include <glm/ext/matrix_transform.hpp>
+#include "CommandBuffer.h"
 #include "TransformComponent.h"
+#include "ember/util/Log.h"
+#include "ember/util/MappedFile.h"
 
 namespace ember::ecs {
+
+    namespace {
+        // Last run tick of the system executing on this thread
+        thread_local const Tick* t_last_run = nullptr;
+        // Time slice of the system executing on this thread
+        thread_local TimeSlice* t_time_slice = nullptr;
+    }
     World::World(): m_next_entity(Entity(WORLD_ORIGIN_ENTITY.id + 1)) {
         add_component<TransformComponent>();
         write_component<TransformComponent>().insert(WORLD_ORIGIN_ENTITY, {});
+        set_thread_pool(nullptr);
     }
 
     World::World(const SystemGraph& systems): World() {
         m_systems = systems;
+        for (const auto& phase : m_systems) {
+            m_system_ticks.emplace_back(phase.size(), Tick(0));
+
+            auto& names = m_system_names.emplace_back();
+            auto& schedules = m_system_schedules.emplace_back();
+            for (const auto sys : phase) {
+                const auto name = system_name(sys);
+                names.push_back(name.empty() ? "system" : name);
+                schedules.emplace_back(system_run_policy(sys));
+            }
+        }
+    }
+
+    World::~World() {
+        m_observers.clear();
+
+        // Plain resources (such as cached queries hooked into storages) go before
+        // the component storages, each group in reverse order of their ids
+        for (const auto storages : { false, true }) {
+            for (auto iter = m_resources.rbegin(); iter != m_resources.rend(); iter++) {
+                if ((iter->data == nullptr) || ((iter->remove_entities != nullptr) != storages)) continue;
+                iter->destroy(iter->data);
+            }
+        }
+    }
+
+    void World::set_thread_pool(std::shared_ptr<util::ThreadPool> pool) {
+        m_thread_pool = std::move(pool);
+
+        const auto slots = (m_thread_pool ? m_thread_pool->worker_count() : 0) + 1;
+        while (m_command_buffers.size() < slots) {
+            m_command_buffers.push_back(std::make_unique<CommandBuffer>(*this));
+            m_command_buffer_list.push_back(m_command_buffers.back().get());
+        }
+    }
+
+    void World::set_profiler(std::shared_ptr<util::Profiler> profiler) {
+        m_profiler = std::move(profiler);
+        m_phase_names.clear();
+        if (!m_profiler) return;
+
+        for (size_t p = 0; p < m_systems.size(); p++) {
+            m_phase_names.push_back(m_profiler->intern("phase " + std::to_string(p)));
+        }
+    }
+
+    void World::set_logger(std::shared_ptr<util::Logger> logger) {
+        m_logger = std::move(logger);
+    }
+
+    CommandBuffer& World::commands() {
+        const auto worker = m_thread_pool ? m_thread_pool->worker_index() : util::ThreadPool::NOT_A_WORKER;
+        return *m_command_buffers[(worker == util::ThreadPool::NOT_A_WORKER) ? 0 : worker + 1];
+    }
+
+    void World::apply_commands() {
+        CommandBuffer::apply(*this, m_command_buffer_list);
     }
 
     void World::run(float dt) {
-        for (const auto& phase : m_systems) {
-            for (const auto sys : phase) {
-                sys(*this, dt);
+        util::ProfileScope run_scope(m_profiler.get(), "World::run", "frame");
+        util::LogScope log_scope(m_logger.get());
+        for (auto p = 0; p < m_systems.size(); p++) {
+            const auto& phase = m_systems[p];
+            auto* last_run = m_system_ticks[p].data();
+            auto* name = m_system_names[p].data();
+            auto* schedule = m_system_schedules[p].data();
+            m_change_tick++;
+
+            // The previous phase, or whatever ran between two runs for the first one,
+            // published into the buffers this phase reads
+            for (const auto id : m_event_channels) {
+                auto& slot = m_resources[id];
+                slot.swap_events(slot.data);
+            }
+
+            util::ProfileScope phase_scope(m_profiler.get(), m_profiler ? m_phase_names[p] : std::string_view(), "phase");
+            if (m_thread_pool && (phase.size() > 1)) {
+                util::TaskGroup group(m_thread_pool.get());
+                for (const auto sys : phase) {
+                    if (schedule->advance(dt, m_run_count)) {
+                        group.run([this, sys, last_run, name, schedule]() { run_system(sys, *last_run, *name, *schedule); });
+                    }
+                    last_run++;
+                    name++;
+                    schedule++;
+                }
+                group.wait();
+            } else {
+                for (const auto sys : phase) {
+                    if (schedule->advance(dt, m_run_count)) run_system(sys, *last_run, *name, *schedule);
+                    last_run++;
+                    name++;
+                    schedule++;
+                }
+            }
+
+            // Changes applied at the barrier (and after the run) get a newer tick than
+            // any system of the phase so every system sees them on its next run
+            m_change_tick++;
+            {
+                util::ProfileScope commands_scope(m_profiler.get(), "apply_commands", "phase");
+                apply_commands();
+            }
+            if (!m_observers.empty()) {
+                util::ProfileScope observers_scope(m_profiler.get(), "deliver_observers", "phase");
+                deliver_observers();
             }
         }
+        m_run_count++;
     }
 
-    Entity World::create_entity() {
-        Entity e;
-        if (!m_recycled_entities.empty()) {
-            e = m_recycled_entities.front();
-            m_recycled_entities.pop();
-        } else {
-            e = m_next_entity;
+    void World::remove_observer(ObserverId id) {
+        std::erase_if(m_observers, [id](const auto& observer) { return observer.first == id; });
+    }
+
+    void World::deliver_observers() {
+        // Callbacks may add observers, so no iterators
+        for (size_t i = 0; i < m_observers.size(); i++) {
+            m_observers[i].second->deliver(*this);
+        }
+    }
+
+    void World::run_system(SystemRunFn sys, Tick& last_run, std::string_view name, RunSchedule& schedule) {
+        util::ProfileScope scope(m_profiler.get(), name, "system");
+        util::LogScope log_scope(m_logger.get());
+        const auto* previous = t_last_run;
+        auto* previous_slice = t_time_slice;
+        t_last_run = &last_run;
+        t_time_slice = &schedule.begin_slice();
+        try {
+            sys(*this, schedule.dt());
+        } catch (...) {
+            t_last_run = previous;
+            t_time_slice = previous_slice;
+            throw;
+        }
+        t_last_run = previous;
+        t_time_slice = previous_slice;
+        last_run = m_change_tick;
+    }
+
+    std::pair<size_t, size_t> World::system_index(SystemRunFn sys) const {
+        for (size_t p = 0; p < m_systems.size(); p++) {
+            const auto iter = m_systems[p].find(sys);
+            if (iter != m_systems[p].end()) return { p, size_t(std::distance(m_systems[p].begin(), iter)) };
+        }
+        throw std::out_of_range("Attempted to access missing system!");
+    }
+
+    void World::set_run_policy(SystemRunFn sys, RunPolicy policy) {
+        const auto [phase, index] = system_index(sys);
+        m_system_schedules[phase][index].set_policy(policy);
+    }
+
+    RunPolicy World::run_policy(SystemRunFn sys) const {
+        const auto [phase, index] = system_index(sys);
+        return m_system_schedules[phase][index].policy();
+    }
+
+    TimeSlice& World::time_slice() {
+        if (t_time_slice == nullptr) throw std::logic_error("Attempted to access a time slice outside of a system!");
+        return *t_time_slice;
+    }
+
+    Tick World::last_run_tick() const {
+        return t_last_run ? *t_last_run : Tick(0);
+    }
+
+    void World::allocate_entities(size_t count, Entity* out) {
+        std::lock_guard lock(m_entity_mutex);
+
+        const auto recycled = std::min(count, m_free_entities.size());
+        std::copy(m_free_entities.end() - recycled, m_free_entities.end(), out);
+        m_free_entities.resize(m_free_entities.size() - recycled);
+
+        for (auto i = recycled; i < count; i++) {
+            out[i] = m_next_entity;
             m_next_entity.id++;
         }
+    }
+
+    Entity World::reserve_entity() {
+        Entity e;
+        allocate_entities(1, &e);
+        return e;
+    }
+
+    Entity World::create_entity() {
+        const auto e = reserve_entity();
 
         auto& storage = write_component<TransformComponent>();
         storage.insert(e, {});
         return e;
     }
 
+    void World::create_entities(size_t count, std::span<Entity> out) {
+        if (out.size() < count) throw std::invalid_argument("create_entities output is too small");
+        if (count == 0) return;
+        allocate_entities(count, out.data());
+
+        uint32_t max_id = 0;
+        for (auto i = 0; i < count; i++) max_id = std::max(max_id, out[i].id);
+
+        auto& storage = write_component<TransformComponent>();
+        storage.reserve(max_id + 1);
+        for (auto i = 0; i < count; i++) storage.insert(out[i], {});
+    }
+
     void World::destroy_entity(Entity e) {
-        assert(e != WORLD_ORIGIN_ENTITY);
-        m_recycled_entities.push(e.generation++);
+        destroy_entities(std::span(&e, 1));
+    }
+
+    void World::destroy_entities(std::span<const Entity> entities) {
+        assert(std::find(entities.begin(), entities.end(), WORLD_ORIGIN_ENTITY) == entities.end());
+
+        // Only live entities are recycled, every id must reach the free list once
+        const auto& transforms = read_component<TransformComponent>();
+        std::vector<Entity> alive;
+        alive.reserve(entities.size());
+        for (const auto e : entities) {
+            if (transforms.contains(e)) alive.push_back(e);
+        }
+        std::sort(alive.begin(), alive.end());
+        alive.erase(std::unique(alive.begin(), alive.end()), alive.end());
+
+        for (auto& slot : m_resources) {
+            if (slot.remove_entities != nullptr) slot.remove_entities(slot.data, alive);
+        }
+
+        std::lock_guard lock(m_entity_mutex);
+        m_free_entities.reserve(m_free_entities.size() + alive.size());
+        for (const auto e : alive) {
+            m_free_entities.push_back(Entity(e.generation + 1, e.id));
+        }
+    }
+
+    void World::save_snapshot(std::ostream& out) const {
+        check_snapshot_support();
+        SnapshotWriter writer(out);
+        save_snapshot(writer);
+    }
+
+    void World::save_snapshot(SnapshotBuffer& out) const {
+        check_snapshot_support();
+        out.clear();
+        SnapshotWriter writer(out);
+        save_snapshot(writer);
+    }
+
+    void World::check_snapshot_support() const {
+        // Skipping a component would restore a world with part of its state left behind
+        for (const auto& slot : m_resources) {
+            if ((slot.data != nullptr) && (slot.remove_entities != nullptr) && (slot.save == nullptr)) {
+                throw std::logic_error("Attempted to snapshot a component storage without snapshot support!");
+            }
+        }
+    }
+
+    void World::save_snapshot(SnapshotWriter& writer) const {
+        writer.write_value(SnapshotHeader { .tick = m_change_tick, .next_entity = m_next_entity.raw });
+        writer.write_block(std::span<const Entity>(m_free_entities));
+
+        for (const auto& slot : m_resources) {
+            if ((slot.data == nullptr) || (slot.save == nullptr)) continue;
+            const auto record = writer.begin_record(slot.type_hash);
+            slot.save(slot.data, writer);
+            writer.end_record(record);
+        }
+    }
+
+    void World::save_snapshot(const std::filesystem::path& path) const {
+        // Checked before truncating the file
+        check_snapshot_support();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("Failed to open file!");
+        save_snapshot(file);
+    }
+
+    void World::load_snapshot(std::span<const std::byte> data) {
+        load_snapshot(data, false);
+    }
+
+    void World::restore_snapshot(std::span<const std::byte> data) {
+        load_snapshot(data, true);
+    }
+
+    void World::load_snapshot(std::span<const std::byte> data, bool restore) {
+        SnapshotReader reader(data);
+
+        const auto header = reader.read_value<SnapshotHeader>();
+        if ((header.magic != SnapshotHeader().magic) || (header.byte_order != SnapshotHeader().byte_order)) {
+            throw std::runtime_error("Not an ember snapshot!");
+        }
+        if (header.version != SNAPSHOT_VERSION) throw std::runtime_error("Unsupported snapshot version!");
+
+        // Rolling back in place must not rewind the tick past the last runs of the
+        // systems, and the reloaded components get a newer tick than anything seen so far
+        m_change_tick = restore ? std::max(m_change_tick, header.tick) + 1 : header.tick;
+        m_next_entity = Entity(header.next_entity);
+        reader.read_into(m_free_entities);
+
+        while (!reader.done()) {
+            const auto record = reader.read_value<SnapshotRecord>();
+            auto body = reader.sub_reader(record.size);
+
+            const auto slot = std::find_if(m_resources.begin(), m_resources.end(), [&](const ResourceSlot& slot) {
+                return (slot.load != nullptr) && (slot.type_hash == record.type_hash);
+            });
+            if (slot == m_resources.end()) continue;
+
+            // Storages last modified before the snapshot was taken still hold its contents
+            const auto unchanged = restore && (slot->modified_tick != nullptr)
+                && tick_newer_than(header.tick, slot->modified_tick(slot->data));
+            if (unchanged) continue;
+
+            slot->load(slot->data, body);
+            if (restore && (slot->mark_changed != nullptr)) slot->mark_changed(slot->data);
+        }
+    }
+
+    void World::load_snapshot(const std::filesystem::path& path) {
+        const auto file = util::MappedFile(path);
+        load_snapshot(file.data());
     }
 }
\ No newline at end of file
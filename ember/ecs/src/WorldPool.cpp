@@ -0,0 +1,93 @@
+#include "WorldPool.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace ember::ecs {
+
+    namespace {
+        // Time spent by worlds run nested inside the world running on this thread,
+        // which happens when a thread waiting on its world's phase picks up another
+        // world. Subtracted so a world is only charged for its own work.
+        thread_local WorldPool::Clock::duration* t_nested_time = nullptr;
+    }
+
+    WorldPool::WorldPool(std::shared_ptr<util::ThreadPool> pool): m_pool(std::move(pool)) { }
+
+    WorldPool::WorldId WorldPool::add(std::shared_ptr<World> world) {
+        if (!world) throw std::invalid_argument("WorldPool requires a world");
+        world->set_thread_pool(m_pool);
+
+        const auto id = m_next_id++;
+        m_entries.push_back({ id, std::move(world), {} });
+        return id;
+    }
+
+    void WorldPool::remove(WorldId id) {
+        const auto iter = std::find_if(m_entries.begin(), m_entries.end(), [id](const auto& e) { return e.id == id; });
+        if (iter == m_entries.end()) throw std::out_of_range("Attempted to remove missing world!");
+        m_entries.erase(iter);
+    }
+
+    WorldPool::Entry& WorldPool::entry(WorldId id) {
+        const auto iter = std::find_if(m_entries.begin(), m_entries.end(), [id](const auto& e) { return e.id == id; });
+        if (iter == m_entries.end()) throw std::out_of_range("Attempted to access missing world!");
+        return *iter;
+    }
+
+    const WorldPool::Entry& WorldPool::entry(WorldId id) const {
+        return const_cast<WorldPool*>(this)->entry(id);
+    }
+
+    World& WorldPool::world(WorldId id) {
+        return *entry(id).world;
+    }
+
+    const WorldPool::Stats& WorldPool::stats(WorldId id) const {
+        return entry(id).stats;
+    }
+
+    void WorldPool::run(float dt, size_t steps) {
+        for (size_t i = 0; i < steps; i++) run_step(dt);
+    }
+
+    void WorldPool::run_step(float dt) {
+        // Longest first: a heavy world started last would leave the other threads
+        // idle at the end of the step
+        m_order.resize(m_entries.size());
+        std::iota(m_order.begin(), m_order.end(), size_t(0));
+        std::stable_sort(m_order.begin(), m_order.end(), [this](size_t lhs, size_t rhs) {
+            return m_entries[lhs].stats.average > m_entries[rhs].stats.average;
+        });
+
+        util::TaskGroup group(m_pool.get());
+        for (const auto index : m_order) {
+            group.run([entry = &m_entries[index], dt]() {
+                auto nested = Clock::duration::zero();
+                auto* outer = t_nested_time;
+                t_nested_time = &nested;
+
+                const auto start = Clock::now();
+                try {
+                    entry->world->run(dt);
+                } catch (...) {
+                    t_nested_time = outer;
+                    throw;
+                }
+                const auto wall = Clock::now() - start;
+                t_nested_time = outer;
+                if (outer) *outer += wall;
+                const auto elapsed = wall - nested;
+
+                auto& stats = entry->stats;
+                stats.last = elapsed;
+                stats.total += elapsed;
+                stats.average = (stats.runs == 0) ? elapsed : (stats.average * 7 + elapsed) / 8;
+                stats.runs++;
+            });
+        }
+        group.wait();
+    }
+
+}
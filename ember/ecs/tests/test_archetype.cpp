@@ -0,0 +1,130 @@
+#include <cstdlib>
+#include <catch2/catch_test_macros.hpp>
+
+#include "Archetype.h"
+#include "Component.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct Position {
+    using Storage = ArchetypeStorage<Position>;
+    float x, y, z;
+};
+static_assert(Component<Position>);
+
+struct Velocity {
+    using Storage = ArchetypeStorage<Velocity>;
+    float x, y, z;
+};
+static_assert(Component<Velocity>);
+
+TEST_CASE("Archetype chunks fit in CHUNK_SIZE", "[Archetype]") {
+    const std::vector<Archetype::ColumnInfo> info { { 12, 4 }, { 64, 16 } };
+    auto archetype = Archetype({ 0, 1 }, info);
+
+    REQUIRE(archetype.chunk_capacity() > 0);
+    REQUIRE(archetype.chunk_capacity() * (sizeof(Entity) + 12 + 64) <= Archetype::CHUNK_SIZE);
+}
+
+TEST_CASE("ArchetypeRegistry moves entities between archetypes as components change", "[Archetype]") {
+    ArchetypeRegistry registry;
+    const auto pos = registry.register_column<Position>();
+    const auto vel = registry.register_column<Velocity>();
+
+    const auto p = Position { 1.0f, 2.0f, 3.0f };
+    const auto v = Velocity { 4.0f, 5.0f, 6.0f };
+
+    registry.insert(1, pos, &p);
+    REQUIRE(registry.contains(1, pos));
+    REQUIRE_FALSE(registry.contains(1, vel));
+
+    registry.insert(1, vel, &v);
+    REQUIRE(registry.contains(1, pos));
+    REQUIRE(registry.contains(1, vel));
+    REQUIRE(reinterpret_cast<const Position*>(registry.get(1, pos))->y == 2.0f);
+    REQUIRE(reinterpret_cast<const Velocity*>(registry.get(1, vel))->z == 6.0f);
+
+    registry.remove(1, pos);
+    REQUIRE_FALSE(registry.contains(1, pos));
+    REQUIRE(reinterpret_cast<const Velocity*>(registry.get(1, vel))->x == 4.0f);
+}
+
+TEST_CASE("ArchetypeRegistry::remove keeps moved entities addressable", "[Archetype]") {
+    ArchetypeRegistry registry;
+    const auto pos = registry.register_column<Position>();
+
+    for (uint32_t i = 0; i < 2000; i++) {
+        const auto p = Position { float(i), 0.0f, 0.0f };
+        registry.insert(i, pos, &p);
+    }
+
+    // Removing from the front swaps the back entity into the hole
+    for (uint32_t i = 0; i < 1000; i++) registry.remove(i, pos);
+
+    for (uint32_t i = 1000; i < 2000; i++) {
+        REQUIRE(reinterpret_cast<const Position*>(registry.get(i, pos))->x == float(i));
+    }
+}
+
+TEST_CASE("ArchetypeRegistry::each_chunk visits entities holding all components", "[Archetype]") {
+    World world;
+    world.add_component<Position>();
+    world.add_component<Velocity>();
+
+    auto& positions = world.write_component<Position>();
+    auto& velocities = world.write_component<Velocity>();
+    for (uint32_t i = 0; i < 100; i++) {
+        positions.insert(i, { float(i), 0.0f, 0.0f });
+        if (i % 2 == 0) velocities.insert(i, { 1.0f, 0.0f, 0.0f });
+    }
+
+    size_t visited = 0;
+    world.archetypes().each_chunk<Position, const Velocity>(
+        [&](std::span<const Entity> entities, std::span<Position> p, std::span<const Velocity> v) {
+            for (auto i = 0; i < entities.size(); i++) {
+                REQUIRE(entities[i].id % 2 == 0);
+                p[i].x += v[i].x;
+            }
+            visited += entities.size();
+        }
+    );
+
+    REQUIRE(visited == 50);
+    REQUIRE(positions.at(2).x == 3.0f);
+    REQUIRE(positions.at(3).x == 3.0f);
+}
+
+TEST_CASE("World binds archetype storages to a shared registry", "[Archetype]") {
+    World world;
+    world.add_component<Position>();
+    world.add_component<Velocity>();
+
+    world.write_component<Position>().insert(7, { 1.0f, 1.0f, 1.0f });
+    world.write_component<Velocity>().insert(7, { 2.0f, 2.0f, 2.0f });
+
+    // Both components of entity 7 live in the same chunk of the same archetype
+    const auto& registry = world.archetypes();
+    const auto* p = registry.get(7, registry.column_id<Position>());
+    const auto* v = registry.get(7, registry.column_id<Velocity>());
+    REQUIRE(std::abs(p - v) < ptrdiff_t(Archetype::CHUNK_SIZE));
+
+    REQUIRE(world.query<Position, Velocity>().contains(7));
+}
+
+TEST_CASE("ArchetypeStorage::insert() replaces a stale generation with a remove and an insert", "[Archetype]") {
+    ArchetypeStorage<Position> storage;
+    size_t inserted = 0;
+    size_t removed = 0;
+    storage.hooks().on_insert([&](Entity) { inserted++; });
+    storage.hooks().on_remove([&](Entity) { removed++; });
+
+    storage.insert(Entity(0, 1), { 1.0f, 0.0f, 0.0f });
+    storage.insert(Entity(1, 1), { 2.0f, 0.0f, 0.0f });
+
+    REQUIRE(storage.size() == 1);
+    REQUIRE(inserted == 2);
+    REQUIRE(removed == 1);
+    REQUIRE_FALSE(storage.contains(Entity(0, 1)));
+    REQUIRE(storage.at(Entity(1, 1)).x == 2.0f);
+}
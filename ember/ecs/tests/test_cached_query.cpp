@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+
+#include "CachedQuery.h"
+#include "CommandBuffer.h"
+#include "Storage.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct QueryComponentA {
+    using Storage = SparseSetStorage<QueryComponentA>;
+    int value;
+};
+static_assert(Component<QueryComponentA>);
+
+struct QueryComponentB {
+    using Storage = MapStorage<QueryComponentB>;
+    int value;
+};
+static_assert(Component<QueryComponentB>);
+
+TEST_CASE("StorageHooks run on insert and remove only", "[CachedQuery]") {
+    SparseSetStorage<int> storage;
+    size_t inserted = 0;
+    size_t removed = 0;
+    const auto insert_hook = storage.hooks().on_insert([&](Entity) { inserted++; });
+    storage.hooks().on_remove([&](Entity e) {
+        REQUIRE(storage.contains(e));
+        removed++;
+    });
+
+    storage.insert(1, 1);
+    storage.insert(1, 2);
+    REQUIRE(inserted == 1);
+
+    // A new generation replacing a stale one counts as remove + insert
+    storage.insert(Entity(1, 1), 3);
+    REQUIRE(inserted == 2);
+    REQUIRE(removed == 1);
+
+    storage.remove(Entity(1, 1));
+    REQUIRE(removed == 2);
+
+    storage.hooks().remove_hook(insert_hook);
+    storage.insert(2, 2);
+    REQUIRE(inserted == 2);
+}
+
+TEST_CASE("CachedQuery follows inserts and removes", "[CachedQuery]") {
+    World world;
+    world.add_component<QueryComponentA>();
+    world.add_component<QueryComponentB>();
+
+    std::vector<Entity> entities(10);
+    world.create_entities(entities.size(), entities);
+
+    auto& a = world.write_component<QueryComponentA>();
+    auto& b = world.write_component<QueryComponentB>();
+    for (uint32_t i = 0; i < 10; i++) {
+        a.insert(entities[i], { int(i) });
+        if (i % 2 == 0) b.insert(entities[i], { int(i) });
+    }
+
+    auto& query = world.cached_query<QueryComponentA, const QueryComponentB>();
+    REQUIRE(&query == &world.cached_query<QueryComponentA, const QueryComponentB>());
+    REQUIRE(query.size() == 5);
+
+    b.insert(entities[3], { 3 });
+    a.remove(entities[4]);
+    b.remove(entities[6]);
+    b.insert(100, { 100 });
+    REQUIRE(query.size() == 4);
+    REQUIRE(query.contains(entities[3]));
+    REQUIRE_FALSE(query.contains(entities[4]));
+    REQUIRE_FALSE(query.contains(100));
+
+    int sum = 0;
+    for (auto [e, ca, cb] : query) {
+        REQUIRE(ca.value == cb.value);
+        ca.value++;
+        sum += cb.value;
+    }
+    REQUIRE(sum == 0 + 2 + 3 + 8);
+    REQUIRE(a.at(entities[3]).value == 4);
+
+    // Destroying entities strips their components and so removes them from the query
+    std::vector<Entity> destroyed { entities[2], entities[3] };
+    world.destroy_entities(destroyed);
+    REQUIRE(query.size() == 2);
+
+    // Deferred commands go through the same hooks
+    CommandBuffer commands(world);
+    const auto e = commands.create_entity();
+    commands.insert(e, QueryComponentA { 7 });
+    commands.insert(e, QueryComponentB { 7 });
+    commands.apply();
+    REQUIRE(query.contains(e));
+}
+
+TEST_CASE("CachedQuery detaches its hooks when destroyed", "[CachedQuery]") {
+    SparseSetStorage<QueryComponentA> a;
+    MapStorage<QueryComponentB> b;
+    {
+        CachedQuery<QueryComponentA, QueryComponentB> query;
+        query.attach(a, b);
+        a.insert(1, { 1 });
+        b.insert(1, { 1 });
+        REQUIRE(query.size() == 1);
+    }
+    a.insert(2, { 2 });
+    b.insert(2, { 2 });
+    a.remove(1);
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ChangeTick.h"
+#include "Storage.h"
+#include "SystemGraph.h"
+#include "View.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct TickedComponent {
+    using Storage = SparseSetStorage<TickedComponent>;
+    int value;
+};
+static_assert(Component<TickedComponent>);
+
+struct TickedVectorComponent {
+    using Storage = VectorStorage<TickedVectorComponent>;
+    int value;
+};
+static_assert(Component<TickedVectorComponent>);
+
+TEST_CASE("tick_newer_than() handles wrap around", "[ChangeTick]") {
+    REQUIRE(tick_newer_than(2, 1));
+    REQUIRE_FALSE(tick_newer_than(1, 1));
+    REQUIRE_FALSE(tick_newer_than(1, 2));
+    REQUIRE(tick_newer_than(3, Tick(-2)));
+}
+
+TEST_CASE("Tracked storages stamp inserts and mutable access", "[ChangeTick]") {
+    Tick tick = 5;
+    SparseSetStorage<int> storage;
+    storage.bind_ticks(tick);
+
+    storage.insert(1, 10);
+    storage.insert(2, 20);
+    REQUIRE(storage.ticks(1).added == 5);
+    REQUIRE(storage.ticks(1).changed == 5);
+
+    tick = 6;
+    const auto& const_storage = storage;
+    REQUIRE(const_storage[1] == 10);
+    REQUIRE(storage.ticks(1).changed == 5);
+
+    storage[1] = 11;
+    REQUIRE(storage.ticks(1).added == 5);
+    REQUIRE(storage.ticks(1).changed == 6);
+
+    // Removing swaps the last component into place along with its ticks
+    storage.remove(1);
+    REQUIRE(storage.ticks(2).changed == 5);
+}
+
+TEST_CASE("View filters on Changed and Added", "[ChangeTick]") {
+    World world;
+    world.add_component<TickedComponent>();
+    world.add_component<TickedVectorComponent>();
+
+    auto& components = world.write_component<TickedComponent>();
+    auto& vector_components = world.write_component<TickedVectorComponent>();
+    for (uint32_t i = 0; i < 10; i++) {
+        components.insert(i, { int(i) });
+        vector_components.insert(i, { int(i) });
+    }
+
+    const auto since = world.change_tick();
+    REQUIRE(View<Added<TickedComponent>>(since, components).extent() == 10);
+    REQUIRE(View<Added<const TickedComponent>>(since - 1, components).size_hint() == 10);
+
+    size_t count = 0;
+    View<Added<const TickedComponent>>(since - 1, components).each([&](Entity, const TickedComponent&) { count++; });
+    REQUIRE(count == 10);
+
+    count = 0;
+    View<Changed<TickedVectorComponent>>(since, vector_components).each([&](Entity, TickedVectorComponent&) { count++; });
+    REQUIRE(count == 0);
+}
+
+namespace {
+    struct WriterSystem {
+        static inline uint32_t s_entity = 0;
+        static void init(World&) { }
+        static void run(World& world, float) {
+            world.write_component<TickedComponent>()[s_entity].value++;
+        }
+    };
+    struct ChangedReaderSystem {
+        static inline size_t s_changed = 0;
+        static inline size_t s_added = 0;
+        static inline int s_changed_sum = 0;
+        static inline uint32_t s_last_added = 0;
+        static void init(World&) { }
+        static void run(World& world, float) {
+            s_changed = 0;
+            s_added = 0;
+            s_changed_sum = 0;
+            for (auto [e, c] : world.view<Changed<const TickedComponent>>()) {
+                s_changed++;
+                s_changed_sum += c.value;
+            }
+            for (auto [e, c] : world.view<Added<const TickedComponent>>()) {
+                s_added++;
+                s_last_added = e.id;
+            }
+        }
+    };
+}
+
+TEST_CASE("Systems only see changes made since their last run", "[ChangeTick]") {
+    SystemGraphBuilder builder;
+    builder.order_systems<WriterSystem, ChangedReaderSystem>();
+
+    World world(builder.build());
+    world.add_component<TickedComponent>();
+    for (uint32_t i = 0; i < 100; i++) {
+        world.write_component<TickedComponent>().insert(i, { 0 });
+    }
+
+    // First run sees everything
+    world.run(0.1f);
+    REQUIRE(ChangedReaderSystem::s_changed == 100);
+    REQUIRE(ChangedReaderSystem::s_changed_sum == 1);
+    REQUIRE(ChangedReaderSystem::s_added == 100);
+
+    WriterSystem::s_entity = 42;
+    world.run(0.1f);
+    REQUIRE(ChangedReaderSystem::s_changed == 1);
+    REQUIRE(ChangedReaderSystem::s_changed_sum == 1);
+    REQUIRE(ChangedReaderSystem::s_added == 0);
+
+    // Changes made between runs are seen too
+    world.write_component<TickedComponent>().insert(100, { 0 });
+    world.run(0.1f);
+    REQUIRE(ChangedReaderSystem::s_changed == 2);
+    REQUIRE(ChangedReaderSystem::s_changed_sum == 2);
+    REQUIRE(ChangedReaderSystem::s_added == 1);
+    REQUIRE(ChangedReaderSystem::s_last_added == 100);
+
+    // Outside of a system views see everything
+    REQUIRE(world.last_run_tick() == 0);
+}
@@ -0,0 +1,129 @@
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+
+#include "CommandBuffer.h"
+#include "Parallel.h"
+#include "Storage.h"
+#include "SystemGraph.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct CommandComponent {
+    using Storage = SparseSetStorage<CommandComponent>;
+    int value;
+};
+static_assert(Component<CommandComponent>);
+
+struct CommandMapComponent {
+    using Storage = MapStorage<CommandMapComponent>;
+    int value;
+};
+static_assert(Component<CommandMapComponent>);
+
+TEST_CASE("CommandBuffer defers changes until applied", "[CommandBuffer]") {
+    World world;
+    world.add_component<CommandComponent>();
+    const auto e = world.create_entity();
+
+    CommandBuffer commands(world);
+    const auto spawned = commands.create_entity();
+    commands.insert(spawned, CommandComponent { 1 });
+    commands.insert(e, CommandComponent { 2 });
+
+    REQUIRE(spawned != e);
+    REQUIRE_FALSE(commands.empty());
+    REQUIRE_FALSE(world.read_component<TransformComponent>().contains(spawned));
+    REQUIRE(world.read_component<CommandComponent>().size() == 0);
+
+    commands.apply();
+    REQUIRE(commands.empty());
+    REQUIRE(world.read_component<TransformComponent>().contains(spawned));
+    REQUIRE(world.read_component<CommandComponent>().at(spawned).value == 1);
+    REQUIRE(world.read_component<CommandComponent>().at(e).value == 2);
+}
+
+TEST_CASE("CommandBuffer keeps the order of commands for one entity", "[CommandBuffer]") {
+    World world;
+    world.add_component<CommandComponent>();
+    world.add_component<CommandMapComponent>();
+
+    CommandBuffer commands(world);
+    for (uint32_t i = 10; i > 0; i--) {
+        commands.insert(i, CommandComponent { int(i) });
+        commands.insert(i, CommandMapComponent { int(i) });
+        if (i % 2) commands.remove<CommandComponent>(i);
+    }
+    commands.insert(4, CommandComponent { 40 });
+    commands.remove<CommandMapComponent>(100);
+    commands.apply();
+
+    const auto& storage = world.read_component<CommandComponent>();
+    REQUIRE(storage.size() == 5);
+    REQUIRE(storage.at(4).value == 40);
+    REQUIRE_FALSE(storage.contains(3));
+    REQUIRE(world.read_component<CommandMapComponent>().at(3).value == 3);
+
+    // Applied ordered by entity so the packed array ends up sorted
+    const auto packed = storage.packed_entities();
+    REQUIRE(std::is_sorted(packed.begin(), packed.end()));
+}
+
+namespace {
+    struct SpawningSystem {
+        static void init(World&) { }
+        static void run(World& world, float) {
+            parallel_for(world.thread_pool(), 1000, 10, [&](size_t begin, size_t end) {
+                auto& commands = world.commands();
+                for (auto i = begin; i < end; i++) {
+                    const auto e = commands.create_entity();
+                    commands.insert(e, CommandComponent { int(i) });
+                }
+            });
+        }
+    };
+    struct CountingSystem {
+        static inline size_t s_count = 0;
+        static void init(World&) { }
+        static void run(World& world, float) {
+            // Commands of the previous phase were applied at the barrier
+            s_count = world.read_component<CommandComponent>().size();
+        }
+    };
+}
+
+TEST_CASE("World::run applies per-thread command buffers at phase barriers", "[CommandBuffer]") {
+    SystemGraphBuilder builder;
+    builder.order_systems<SpawningSystem, CountingSystem>();
+
+    World world(builder.build());
+    world.add_component<CommandComponent>();
+    world.set_thread_pool(std::make_shared<ember::util::ThreadPool>(4));
+
+    CountingSystem::s_count = 0;
+    world.run(0.1f);
+    REQUIRE(CountingSystem::s_count == 1000);
+
+    // Every spawned entity got its own id
+    const auto& storage = world.read_component<CommandComponent>();
+    EntitySet ids;
+    for (const auto e : storage.packed_entities()) {
+        REQUIRE_FALSE(ids.contains(e));
+        ids.insert(e);
+        REQUIRE(world.read_component<TransformComponent>().contains(e));
+    }
+}
+
+TEST_CASE("CommandBuffer applies despawns after component changes", "[CommandBuffer]") {
+    World world;
+    world.add_component<CommandComponent>();
+    const auto e = world.create_entity();
+
+    CommandBuffer commands(world);
+    commands.insert(e, CommandComponent { 1 });
+    commands.destroy_entity(e);
+    commands.apply();
+
+    REQUIRE_FALSE(world.read_component<CommandComponent>().contains(e));
+    REQUIRE(world.create_entity().id == e.id);
+}
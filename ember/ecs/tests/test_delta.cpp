@@ -0,0 +1,135 @@
+#include <cstring>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "Delta.h"
+#include "SoaStorage.h"
+#include "Storage.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct DeltaPosition {
+    using Storage = SparseSetStorage<DeltaPosition>;
+    float x, y, z;
+    uint32_t flags;
+};
+static_assert(Component<DeltaPosition>);
+
+struct DeltaHealth {
+    using Storage = MapStorage<DeltaHealth>;
+    int value;
+};
+static_assert(Component<DeltaHealth>);
+
+namespace {
+    template<Component T>
+    void require_same(const World& lhs, const World& rhs) {
+        const auto& l = lhs.read_component<T>();
+        const auto& r = rhs.read_component<T>();
+        REQUIRE(l.size() == r.size());
+        for (const auto e : l.entities()) {
+            REQUIRE(r.contains(e));
+            const T a = l[e];
+            const T b = r[e];
+            REQUIRE(std::memcmp(&a, &b, sizeof(T)) == 0);
+        }
+    }
+}
+
+TEST_CASE("DeltaWriter and DeltaReader round trip varints", "[Delta]") {
+    std::vector<std::byte> buffer;
+    DeltaWriter writer(buffer);
+    const uint64_t values[] = { 0, 1, 127, 128, 300, 1ull << 35, ~0ull };
+    for (const auto v : values) writer.write_varint(v);
+    REQUIRE(buffer.size() == 1 + 1 + 1 + 2 + 2 + 6 + 10);
+
+    DeltaReader reader(buffer);
+    for (const auto v : values) REQUIRE(reader.read_varint() == v);
+    REQUIRE(reader.done());
+    REQUIRE_THROWS_AS(reader.read_byte(), std::runtime_error);
+}
+
+TEST_CASE("Deltas replicate a world into another", "[Delta]") {
+    World server;
+    World client;
+    server.add_component<DeltaPosition>();
+    server.add_component<DeltaHealth>();
+
+    DeltaEncoder encoder;
+    encoder.add_component<DeltaPosition>();
+    encoder.add_component<DeltaHealth>();
+    DeltaDecoder decoder;
+    decoder.add_component<DeltaPosition>();
+    decoder.add_component<DeltaHealth>();
+
+    std::vector<Entity> entities(100);
+    server.create_entities(entities.size(), entities);
+    for (auto i = 0; i < 100; i++) {
+        server.write_component<DeltaPosition>().insert(entities[i], { float(i), 0.0f, 0.0f, 0 });
+        if (i % 3 == 0) server.write_component<DeltaHealth>().insert(entities[i], { 100 });
+    }
+
+    std::vector<std::byte> delta;
+    encoder.encode(server, delta);
+    decoder.apply(client, delta);
+    require_same<DeltaPosition>(server, client);
+    require_same<DeltaHealth>(server, client);
+    const auto full_size = delta.size();
+
+    SECTION("Nothing changed") {
+        delta.clear();
+        encoder.encode(server, delta);
+        REQUIRE(delta.size() == 1);
+        decoder.apply(client, delta);
+        require_same<DeltaPosition>(server, client);
+    }
+
+    SECTION("A few changes cost a few bytes") {
+        server.write_component<DeltaPosition>()[entities[10]].y = 2.0f;
+        server.write_component<DeltaHealth>()[entities[9]].value = 50;
+        server.write_component<DeltaHealth>().remove(entities[3]);
+        server.write_component<DeltaHealth>().insert(entities[4], { 7 });
+
+        delta.clear();
+        encoder.encode(server, delta);
+        REQUIRE(delta.size() < full_size / 10);
+        decoder.apply(client, delta);
+        require_same<DeltaPosition>(server, client);
+        require_same<DeltaHealth>(server, client);
+        REQUIRE(!client.read_component<DeltaHealth>().contains(entities[3]));
+    }
+
+    SECTION("Destroyed and recycled entities") {
+        server.destroy_entities(std::span(entities).subspan(0, 10));
+        std::vector<Entity> recycled(5);
+        server.create_entities(recycled.size(), recycled);
+        for (const auto e : recycled) server.write_component<DeltaPosition>().insert(e, { -1.0f, -1.0f, -1.0f, 1 });
+
+        delta.clear();
+        encoder.encode(server, delta);
+        decoder.apply(client, delta);
+        require_same<DeltaPosition>(server, client);
+        require_same<DeltaHealth>(server, client);
+    }
+
+    SECTION("Unknown storages are skipped") {
+        DeltaDecoder partial;
+        partial.add_component<DeltaHealth>();
+        World other;
+        encoder.reset();
+        delta.clear();
+        encoder.encode(server, delta);
+        partial.apply(other, delta);
+        require_same<DeltaHealth>(server, other);
+        REQUIRE(!other.has_component<DeltaPosition>());
+    }
+
+    SECTION("Truncated deltas throw") {
+        server.write_component<DeltaPosition>()[entities[1]].x = 5.0f;
+        delta.clear();
+        encoder.encode(server, delta);
+        delta.pop_back();
+        REQUIRE_THROWS_AS(decoder.apply(client, delta), std::runtime_error);
+    }
+}
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "EventChannel.h"
+#include "SystemGraph.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct TestEvent {
+    int value = 0;
+};
+
+TEST_CASE("EventChannel makes events readable after a swap", "[EventChannel]") {
+    EventChannel<TestEvent> channel(4);
+    REQUIRE(channel.read().empty());
+
+    channel.publish({1});
+    channel.publish({2});
+    REQUIRE(channel.read().empty());
+
+    channel.swap();
+    REQUIRE(channel.read().size() == 2);
+    REQUIRE(channel.read()[0].value == 1);
+    REQUIRE(channel.read()[1].value == 2);
+
+    // Events published while reading go to the other buffer
+    channel.publish({3});
+    REQUIRE(channel.read().size() == 2);
+
+    channel.swap();
+    REQUIRE(channel.read().size() == 1);
+    REQUIRE(channel.read()[0].value == 3);
+
+    channel.swap();
+    REQUIRE(channel.read().empty());
+}
+
+TEST_CASE("EventChannel keeps overflowed events and grows", "[EventChannel]") {
+    EventChannel<TestEvent> channel(2);
+    for (auto i = 0; i < 5; i++) channel.publish({i});
+
+    channel.swap();
+    const auto events = channel.read();
+    REQUIRE(events.size() == 5);
+    for (auto i = 0; i < 5; i++) REQUIRE(events[i].value == i);
+    REQUIRE(channel.capacity() >= 5);
+
+    for (auto i = 0; i < 5; i++) channel.publish({i});
+    channel.swap();
+    REQUIRE(channel.read().size() == 5);
+}
+
+TEST_CASE("EventChannel accepts events from many threads", "[EventChannel]") {
+    ember::util::ThreadPool pool(4);
+    EventChannel<TestEvent> channel(64);
+
+    {
+        ember::util::TaskGroup group(&pool);
+        for (auto t = 0; t < 8; t++) {
+            group.run([&channel, t]() {
+                for (auto i = 0; i < 100; i++) channel.publish({t*100 + i});
+            });
+        }
+        group.wait();
+    }
+    channel.swap();
+
+    std::vector<int> values;
+    for (const auto& e : channel.read()) values.push_back(e.value);
+    std::sort(values.begin(), values.end());
+    REQUIRE(values.size() == 800);
+    for (auto i = 0; i < 800; i++) REQUIRE(values[i] == i);
+}
+
+namespace {
+    std::vector<int> s_received;
+    std::vector<int> s_received_late;
+
+    struct EventPublisherA {
+        using Access = ember::ecs::Access<>;
+        static void init(World&) { }
+        static void run(World& world, float) { world.events<TestEvent>().publish({1}); }
+    };
+    struct EventPublisherB {
+        using Access = ember::ecs::Access<>;
+        static void init(World&) { }
+        static void run(World& world, float) { world.events<TestEvent>().publish({2}); }
+    };
+    struct EventReceiver {
+        using Access = ember::ecs::Access<>;
+        static void init(World&) { }
+        static void run(World& world, float) {
+            for (const auto& e : world.events<TestEvent>().read()) s_received.push_back(e.value);
+        }
+    };
+    struct LateEventReceiver {
+        using Access = ember::ecs::Access<>;
+        static void init(World&) { }
+        static void run(World& world, float) {
+            for (const auto& e : world.events<TestEvent>().read()) s_received_late.push_back(e.value);
+        }
+    };
+}
+
+TEST_CASE("World::run delivers the events published during a phase to the next one", "[EventChannel]") {
+    SystemGraphBuilder builder;
+    builder.order_systems<EventPublisherA, EventReceiver>();
+    builder.order_systems<EventPublisherB, EventReceiver>();
+    builder.order_systems<EventReceiver, LateEventReceiver>();
+
+    World world(builder.build());
+    world.set_thread_pool(std::make_shared<ember::util::ThreadPool>(4));
+    world.add_events<TestEvent>();
+    s_received.clear();
+    s_received_late.clear();
+
+    // Readable in the phase after the publishers and dropped after it
+    world.run(0.0f);
+    std::sort(s_received.begin(), s_received.end());
+    REQUIRE(s_received == std::vector<int> { 1, 2 });
+    REQUIRE(s_received_late.empty());
+
+    s_received.clear();
+    world.run(0.0f);
+    REQUIRE(s_received.size() == 2);
+    REQUIRE(s_received_late.empty());
+}
@@ -0,0 +1,120 @@
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "CommandBuffer.h"
+#include "Observer.h"
+#include "Storage.h"
+#include "SystemGraph.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct ObservedComponent {
+    using Storage = SparseSetStorage<ObservedComponent>;
+    int value;
+};
+static_assert(Component<ObservedComponent>);
+
+struct ObservedMapComponent {
+    using Storage = MapStorage<ObservedMapComponent>;
+    int value;
+};
+static_assert(Component<ObservedMapComponent>);
+
+TEST_CASE("StorageHooks report replacing the component of the same entity", "[Observer]") {
+    SparseSetStorage<int> storage;
+    size_t replaced = 0;
+    storage.hooks().on_replace([&](Entity) { replaced++; });
+
+    storage.insert(1, 1);
+    REQUIRE(replaced == 0);
+    storage.insert(1, 2);
+    REQUIRE(replaced == 1);
+
+    // A new generation is a remove and an insert, not a replace
+    storage.insert(Entity(1, 1), 3);
+    REQUIRE(replaced == 1);
+}
+
+TEST_CASE("ComponentObserver delivers changes in order and in batches", "[Observer]") {
+    World world;
+    std::vector<ComponentChange> changes;
+    size_t batches = 0;
+    world.observe<ObservedMapComponent>([&](World&, std::span<const ComponentChange> batch) {
+        changes.insert(changes.end(), batch.begin(), batch.end());
+        batches++;
+    });
+
+    auto& storage = world.write_component<ObservedMapComponent>();
+    const auto e0 = world.create_entity();
+    const auto e1 = world.create_entity();
+    storage.insert(e0, {0});
+    storage.insert(e1, {1});
+    storage.insert(e0, {2});
+    storage.remove(e1);
+
+    // Nothing is delivered inline
+    REQUIRE(changes.empty());
+
+    world.deliver_observers();
+    REQUIRE(batches == 1);
+    REQUIRE(changes.size() == 4);
+    REQUIRE((changes[0].entity == e0 && changes[0].event == ComponentEvent::Inserted));
+    REQUIRE((changes[1].entity == e1 && changes[1].event == ComponentEvent::Inserted));
+    REQUIRE((changes[2].entity == e0 && changes[2].event == ComponentEvent::Replaced));
+    REQUIRE((changes[3].entity == e1 && changes[3].event == ComponentEvent::Removed));
+
+    // Empty batches are not delivered
+    world.deliver_observers();
+    REQUIRE(batches == 1);
+}
+
+TEST_CASE("World::remove_observer unhooks the observer", "[Observer]") {
+    World world;
+    size_t delivered = 0;
+    const auto id = world.observe<ObservedComponent>([&](World&, std::span<const ComponentChange> batch) {
+        delivered += batch.size();
+    });
+
+    world.write_component<ObservedComponent>().insert(world.create_entity(), {1});
+    world.remove_observer(id);
+    world.write_component<ObservedComponent>().insert(world.create_entity(), {2});
+    world.deliver_observers();
+    REQUIRE(delivered == 0);
+}
+
+namespace {
+    std::vector<size_t> s_batch_sizes;
+
+    struct ObservedSpawnSystem {
+        static void init(World&) { }
+        static void run(World& world, float) {
+            for (auto i = 0; i < 3; i++) world.commands().insert<ObservedComponent>(world.commands().create_entity(), {i});
+        }
+    };
+    struct ObservedCheckSystem {
+        static void init(World&) { }
+        static void run(World&, float) {
+            // The spawns of the previous phase were applied and delivered at the barrier
+            REQUIRE(s_batch_sizes.size() == 1);
+        }
+    };
+}
+
+TEST_CASE("World::run delivers observed changes at the phase barrier", "[Observer]") {
+    SystemGraphBuilder builder;
+    builder.order_systems<ObservedSpawnSystem, ObservedCheckSystem>();
+
+    World world(builder.build());
+    world.observe<ObservedComponent>([&](World& w, std::span<const ComponentChange> batch) {
+        for (const auto& change : batch) {
+            REQUIRE(change.event == ComponentEvent::Inserted);
+            REQUIRE(w.read_component<ObservedComponent>().contains(change.entity));
+        }
+        s_batch_sizes.push_back(batch.size());
+    });
+
+    s_batch_sizes.clear();
+    world.run(0.0f);
+    REQUIRE(s_batch_sizes == std::vector<size_t> { 3 });
+}
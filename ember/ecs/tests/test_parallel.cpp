@@ -0,0 +1,123 @@
+#include <array>
+#include <atomic>
+#include <functional>
+#include <catch2/catch_test_macros.hpp>
+
+#include "Parallel.h"
+#include "Storage.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct ParallelComponent {
+    using Storage = SparseSetStorage<ParallelComponent>;
+    int value;
+};
+static_assert(Component<ParallelComponent>);
+
+struct ParallelMapComponent {
+    using Storage = MapStorage<ParallelMapComponent>;
+    int value;
+};
+static_assert(Component<ParallelMapComponent>);
+
+TEST_CASE("cache_line_elements() spans whole cache lines", "[Parallel]") {
+    REQUIRE(cache_line_elements<uint32_t>() == 16);
+    REQUIRE(cache_line_elements<uint64_t>() == 8);
+    REQUIRE((cache_line_elements<std::array<char, 12>>() * 12) % CACHE_LINE_SIZE == 0);
+}
+
+TEST_CASE("parallel_for() covers the range exactly once", "[Parallel]") {
+    ember::util::ThreadPool pool(4);
+    std::vector<std::atomic<int>> visits(10000);
+
+    parallel_for(&pool, visits.size(), 100, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++) visits[i]++;
+    }, 37);
+
+    for (const auto& v : visits) REQUIRE(v == 1);
+}
+
+TEST_CASE("parallel_for_each() visits every component of a storage", "[Parallel]") {
+    ember::util::ThreadPool pool(4);
+    SparseSetStorage<int> storage;
+    for (auto i = 0; i < 10000; i++) storage.insert(i, i);
+
+    parallel_for_each(&pool, storage, [](int& value) { value *= 2; }, 64);
+
+    for (auto i = 0; i < 10000; i++) REQUIRE(storage.at(i) == 2*i);
+}
+
+TEST_CASE("parallel_for_each() runs inline without a pool", "[Parallel]") {
+    SparseSetStorage<int> storage;
+    for (auto i = 0; i < 100; i++) storage.insert(i, 1);
+
+    Reduction<int> sum(nullptr);
+    parallel_for_each(nullptr, storage, [&](int& value) { sum.local() += value; });
+
+    REQUIRE(sum.combine(0, std::plus<int>()) == 100);
+}
+
+TEST_CASE("parallel_for_each() over a view with per-thread reduction", "[Parallel]") {
+    ember::util::ThreadPool pool(4);
+    World world;
+    world.add_component<ParallelComponent>();
+    world.add_component<ParallelMapComponent>();
+
+    auto& components = world.write_component<ParallelComponent>();
+    auto& map_components = world.write_component<ParallelMapComponent>();
+    for (auto i = 0; i < 5000; i++) {
+        components.insert(i, {1});
+        if (i % 2) map_components.insert(i, {2});
+    }
+
+    SECTION("Packed driver") {
+        Reduction<int> sum(&pool);
+        parallel_for_each(&pool, world.view<const ParallelComponent>(), [&](Entity, const ParallelComponent& c) {
+            sum.local() += c.value;
+        }, 128);
+        REQUIRE(sum.combine(0, std::plus<int>()) == 5000);
+    }
+
+    SECTION("EntitySet driver") {
+        Reduction<int> sum(&pool);
+        parallel_for_each(
+            &pool,
+            world.view<const ParallelComponent, const ParallelMapComponent>(),
+            [&](Entity, const ParallelComponent& c, const ParallelMapComponent& m) {
+                sum.local() += c.value + m.value;
+            },
+            128
+        );
+        REQUIRE(sum.combine(0, std::plus<int>()) == 2500 * 3);
+    }
+}
+
+TEST_CASE("parallel_for_each() writes through a view from several workers", "[Parallel]") {
+    ember::util::ThreadPool pool(8);
+    World world;
+    world.add_component<ParallelComponent>();
+    world.add_component<ParallelMapComponent>();
+    for (auto i = 0; i < 20000; i++) {
+        world.write_component<ParallelComponent>().insert(i, {1});
+        if (i % 2) world.write_component<ParallelMapComponent>().insert(i, {2});
+    }
+
+    // Runs with every storage stamped at an older tick, so the view stamps them anew
+    const auto since = world.change_tick();
+    world.advance_change_tick();
+    parallel_for_each(&pool, world.view<ParallelComponent, ParallelMapComponent>(), [](Entity, ParallelComponent& c, ParallelMapComponent& m) {
+        c.value += m.value;
+        m.value = 0;
+    }, 64);
+
+    const auto& components = world.read_component<ParallelComponent>();
+    REQUIRE(components.modified_tick() == world.change_tick());
+    REQUIRE(world.read_component<ParallelMapComponent>().modified_tick() == world.change_tick());
+    size_t changed = 0;
+    View<Changed<const ParallelComponent>>(since, components).each([&](Entity e, const ParallelComponent& c) {
+        REQUIRE(c.value == 3);
+        changed++;
+    });
+    REQUIRE(changed == 10000);
+}
@@ -0,0 +1,216 @@
+#include <cstring>
+#include <sstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "Archetype.h"
+#include "Delta.h"
+#include "Rollback.h"
+#include "Storage.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct RollbackComponent {
+    using Storage = SparseSetStorage<RollbackComponent>;
+    int value;
+};
+static_assert(Component<RollbackComponent>);
+
+struct RollbackStaticComponent {
+    using Storage = VectorStorage<RollbackStaticComponent>;
+    float value;
+};
+static_assert(Component<RollbackStaticComponent>);
+
+namespace {
+    void setup(World& world, std::vector<Entity>& entities) {
+        world.add_component<RollbackComponent>();
+        world.add_component<RollbackStaticComponent>();
+        world.create_entities(entities.size(), entities);
+        for (const auto e : entities) {
+            world.write_component<RollbackComponent>().insert(e, { 0 });
+            world.write_component<RollbackStaticComponent>().insert(e, { float(e.id) });
+        }
+    }
+
+    // Every component holds the frame it was last stepped to
+    void step(World& world, int frame) {
+        auto& storage = world.write_component<RollbackComponent>();
+        for (const auto e : storage.entities()) storage[e].value = frame;
+    }
+}
+
+TEST_CASE("SnapshotWriter writes the same bytes to a buffer as to a stream", "[Rollback]") {
+    World world;
+    std::vector<Entity> entities(50);
+    setup(world, entities);
+
+    std::ostringstream stream;
+    world.save_snapshot(stream);
+    const auto expected = stream.str();
+
+    SnapshotBuffer buffer;
+    world.save_snapshot(buffer);
+    REQUIRE(buffer.size() == expected.size());
+    REQUIRE(std::memcmp(buffer.data(), expected.data(), expected.size()) == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(buffer.data()) % SNAPSHOT_ALIGNMENT == 0);
+
+    // Saving again replaces the contents
+    world.save_snapshot(buffer);
+    REQUIRE(buffer.size() == expected.size());
+}
+
+TEST_CASE("RollbackBuffer restores saved frames", "[Rollback]") {
+    World world;
+    std::vector<Entity> entities(100);
+    setup(world, entities);
+
+    RollbackBuffer rollback(8);
+    for (int frame = 1; frame <= 5; frame++) {
+        step(world, frame);
+        rollback.save(world, frame);
+    }
+    const auto created = world.create_entity();
+    world.write_component<RollbackComponent>().insert(created, { 6 });
+    world.destroy_entity(entities[0]);
+
+    rollback.restore(world, 3);
+    for (const auto e : entities) {
+        REQUIRE(world.read_component<RollbackComponent>()[e].value == 3);
+        REQUIRE(world.read_component<RollbackStaticComponent>()[e].value == float(e.id));
+    }
+    REQUIRE(!world.read_component<RollbackComponent>().contains(created));
+    // Later frames are dropped, the simulation replaces them
+    REQUIRE(rollback.latest() == 3);
+    REQUIRE(!rollback.contains(4));
+
+    // The entity allocator is restored too, the new entity gets the same id again
+    REQUIRE(world.create_entity() == created);
+}
+
+TEST_CASE("RollbackBuffer overwrites the oldest frames", "[Rollback]") {
+    World world;
+    std::vector<Entity> entities(10);
+    setup(world, entities);
+
+    RollbackBuffer rollback(4);
+    REQUIRE(rollback.empty());
+    for (int frame = 1; frame <= 10; frame++) {
+        step(world, frame);
+        rollback.save(world, frame);
+    }
+    REQUIRE(rollback.size() == 4);
+    REQUIRE(rollback.oldest() == 7);
+    REQUIRE(rollback.latest() == 10);
+    REQUIRE(!rollback.contains(6));
+    REQUIRE_THROWS_AS(rollback.restore(world, 6), std::out_of_range);
+
+    // Saving an earlier frame again replaces it and everything after it
+    rollback.save(world, 8);
+    REQUIRE(rollback.size() == 2);
+    REQUIRE(rollback.latest() == 8);
+
+    rollback.restore(world, 7);
+    REQUIRE(world.read_component<RollbackComponent>()[entities[0]].value == 7);
+
+    rollback.clear();
+    REQUIRE(rollback.empty());
+    REQUIRE_THROWS_AS(rollback.oldest(), std::out_of_range);
+    REQUIRE_THROWS_AS(RollbackBuffer(0), std::invalid_argument);
+}
+
+TEST_CASE("RollbackBuffer only reloads storages that changed", "[Rollback]") {
+    World world;
+    std::vector<Entity> entities(20);
+    setup(world, entities);
+
+    RollbackBuffer rollback(2);
+    rollback.save(world, 1);
+    step(world, 2);
+
+    size_t changed_hooks = 0;
+    size_t static_hooks = 0;
+    world.write_component<RollbackComponent>().hooks().on_insert([&](Entity) { changed_hooks++; });
+    world.write_component<RollbackStaticComponent>().hooks().on_insert([&](Entity) { static_hooks++; });
+
+    const auto tick = world.change_tick();
+    rollback.restore(world, 1);
+    REQUIRE(changed_hooks == entities.size());
+    REQUIRE(static_hooks == 0);
+    REQUIRE(world.read_component<RollbackComponent>()[entities[5]].value == 0);
+    // The change tick keeps moving forward
+    REQUIRE(world.change_tick() >= tick);
+
+    // Removing leaves no component ticks behind but still counts as a modification
+    rollback.save(world, 2);
+    world.write_component<RollbackStaticComponent>().remove(entities[3]);
+    rollback.restore(world, 2);
+    REQUIRE(world.read_component<RollbackStaticComponent>().contains(entities[3]));
+    REQUIRE(static_hooks == entities.size());
+}
+
+TEST_CASE("RollbackBuffer marks the reloaded components changed", "[Rollback]") {
+    World world;
+    std::vector<Entity> entities(20);
+    setup(world, entities);
+
+    World replica;
+    replica.add_component<RollbackComponent>();
+    DeltaEncoder encoder;
+    encoder.add_component<RollbackComponent>();
+    DeltaDecoder decoder;
+    decoder.add_component<RollbackComponent>();
+
+    RollbackBuffer rollback(2);
+    rollback.save(world, 1);
+    step(world, 2);
+
+    std::vector<std::byte> delta;
+    encoder.encode(world, delta);
+    decoder.apply(replica, delta);
+    REQUIRE(replica.read_component<RollbackComponent>()[entities[5]].value == 2);
+
+    const auto since = world.change_tick();
+    rollback.restore(world, 1);
+
+    size_t changed = 0;
+    View<Changed<const RollbackComponent>>(since, world.read_component<RollbackComponent>()).each([&](Entity, const RollbackComponent&) { changed++; });
+    REQUIRE(changed == entities.size());
+    // Storages left alone keep their ticks
+    size_t static_changed = 0;
+    View<Changed<const RollbackStaticComponent>>(since, world.read_component<RollbackStaticComponent>()).each([&](Entity, const RollbackStaticComponent&) { static_changed++; });
+    REQUIRE(static_changed == 0);
+
+    // Deltas after the rollback carry the restored values
+    delta.clear();
+    encoder.encode(world, delta);
+    decoder.apply(replica, delta);
+    for (const auto e : entities) REQUIRE(replica.read_component<RollbackComponent>()[e].value == 0);
+}
+
+struct RollbackArchetypeComponent {
+    using Storage = ArchetypeStorage<RollbackArchetypeComponent>;
+    int value;
+};
+static_assert(Component<RollbackArchetypeComponent>);
+
+TEST_CASE("Snapshots refuse worlds with storages that cannot be saved", "[Rollback]") {
+    World world;
+    std::vector<Entity> entities(10);
+    setup(world, entities);
+
+    RollbackBuffer rollback(2);
+    rollback.save(world, 1);
+    rollback.save(world, 2);
+
+    world.add_component<RollbackArchetypeComponent>();
+    world.write_component<RollbackArchetypeComponent>().insert(entities[0], { 1 });
+    REQUIRE_THROWS_AS(rollback.save(world, 3), std::logic_error);
+    SnapshotBuffer buffer;
+    REQUIRE_THROWS_AS(world.save_snapshot(buffer), std::logic_error);
+
+    // The saved frames are kept
+    REQUIRE(rollback.size() == 2);
+    REQUIRE(rollback.oldest() == 1);
+    REQUIRE(rollback.latest() == 2);
+}
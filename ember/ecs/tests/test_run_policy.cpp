@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "RunPolicy.h"
+#include "SystemGraph.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+TEST_CASE("RunSchedule runs every n frames with an offset", "[RunPolicy]") {
+    RunSchedule schedule(RunPolicy::every_n_frames(3, 1));
+
+    std::vector<uint64_t> frames;
+    for (uint64_t frame = 0; frame < 9; frame++) {
+        if (schedule.advance(0.1f, frame)) frames.push_back(frame);
+    }
+    REQUIRE(frames == std::vector<uint64_t> { 1, 4, 7 });
+    // Elapsed time of the frames since the last run
+    REQUIRE(std::abs(schedule.dt() - 0.3f) < 1e-5f);
+}
+
+TEST_CASE("RunSchedule runs at a fixed rate without catching up", "[RunPolicy]") {
+    RunSchedule schedule(RunPolicy::fixed_rate(10.0f));
+
+    size_t runs = 0;
+    for (auto i = 0; i < 100; i++) {
+        if (schedule.advance(0.01f, i)) runs++;
+    }
+    REQUIRE(runs >= 9);
+    REQUIRE(runs <= 10);
+
+    // A long frame runs the system once and drops the missed intervals
+    REQUIRE(schedule.advance(1.0f, 100));
+    REQUIRE(!schedule.advance(0.01f, 101));
+}
+
+TEST_CASE("RunPolicy rejects invalid arguments", "[RunPolicy]") {
+    REQUIRE_THROWS_AS(RunPolicy::every_n_frames(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(RunPolicy::fixed_rate(0.0f), std::invalid_argument);
+}
+
+TEST_CASE("TimeSlice resumes where the budget ran out", "[RunPolicy]") {
+    TimeSlice slice;
+    std::vector<size_t> visited;
+
+    // Already expired: only the first check interval is processed
+    slice.set_deadline(TimeSlice::Clock::now() - std::chrono::seconds(1));
+    REQUIRE(!slice.run(10, [&](size_t i) { visited.push_back(i); }, 4));
+    REQUIRE(visited == std::vector<size_t> { 0, 1, 2, 3 });
+    REQUIRE(slice.cursor() == 4);
+
+    REQUIRE(!slice.run(10, [&](size_t i) { visited.push_back(i); }, 4));
+    slice.set_deadline(TimeSlice::Clock::time_point::max());
+    REQUIRE(slice.run(10, [&](size_t i) { visited.push_back(i); }, 4));
+    REQUIRE(visited.size() == 10);
+    for (size_t i = 0; i < 10; i++) REQUIRE(visited[i] == i);
+    REQUIRE(slice.cursor() == 0);
+
+    // A range that shrank below the cursor starts over
+    slice.set_deadline(TimeSlice::Clock::now() - std::chrono::seconds(1));
+    slice.run(10, [](size_t) { }, 8);
+    visited.clear();
+    slice.run(5, [&](size_t i) { visited.push_back(i); }, 8);
+    REQUIRE(visited.front() == 0);
+}
+
+namespace {
+    size_t s_every_runs = 0;
+    float s_every_dt = 0.0f;
+    size_t s_budget_processed = 0;
+
+    struct EveryOtherFrameSystem {
+        static constexpr RunPolicy RUN_POLICY = RunPolicy::every_n_frames(2);
+
+        static void init(World&) { }
+        static void run(World&, float dt) {
+            s_every_runs++;
+            s_every_dt = dt;
+        }
+    };
+
+    struct BudgetedSystem {
+        static constexpr RunPolicy RUN_POLICY = RunPolicy::time_budget(std::chrono::microseconds(0));
+
+        static void init(World&) { }
+        static void run(World& world, float) {
+            world.time_slice().run(100, [](size_t) { s_budget_processed++; }, 10);
+        }
+    };
+}
+
+TEST_CASE("World::run applies the run policies of its systems", "[RunPolicy]") {
+    SystemGraphBuilder builder;
+    builder.add_system<EveryOtherFrameSystem>();
+    builder.add_system<BudgetedSystem>();
+    REQUIRE(system_run_policy(EveryOtherFrameSystem::run).kind == RunPolicy::Kind::EveryNFrames);
+
+    World world(builder.build());
+    s_every_runs = 0;
+    s_budget_processed = 0;
+
+    for (auto i = 0; i < 4; i++) world.run(0.25f);
+    REQUIRE(s_every_runs == 2);
+    REQUIRE(std::abs(s_every_dt - 0.5f) < 1e-5f);
+    // A spent budget still makes progress one check interval per run
+    REQUIRE(s_budget_processed == 40);
+
+    world.set_run_policy(EveryOtherFrameSystem::run, RunPolicy::always());
+    world.set_run_policy(BudgetedSystem::run, RunPolicy::always());
+    REQUIRE(world.run_policy(BudgetedSystem::run).kind == RunPolicy::Kind::Always);
+    world.run(0.25f);
+    REQUIRE(s_every_runs == 3);
+    // Resumed at 40 and finished the range
+    REQUIRE(s_budget_processed == 100);
+
+    REQUIRE_THROWS_AS(world.time_slice(), std::logic_error);
+}
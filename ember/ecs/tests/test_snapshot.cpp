@@ -0,0 +1,153 @@
+#include <filesystem>
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "Snapshot.h"
+#include "Storage.h"
+#include "TransformComponent.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct SnapshotComponent {
+    using Storage = SparseSetStorage<SnapshotComponent>;
+    int value;
+    float weight;
+};
+static_assert(Component<SnapshotComponent>);
+
+struct SnapshotMapComponent {
+    using Storage = MapStorage<SnapshotMapComponent>;
+    int value;
+};
+static_assert(Component<SnapshotMapComponent>);
+
+struct SnapshotExtraComponent {
+    using Storage = SparseSetStorage<SnapshotExtraComponent>;
+    int value;
+};
+static_assert(Component<SnapshotExtraComponent>);
+
+namespace {
+    std::filesystem::path snapshot_path() {
+        return std::filesystem::temp_directory_path() / "ember_test_snapshot.bin";
+    }
+}
+
+TEST_CASE("stable_type_hash() differs between types", "[Snapshot]") {
+    static_assert(stable_type_hash<SnapshotComponent>() == stable_type_hash<SnapshotComponent>());
+    REQUIRE(stable_type_hash<SnapshotComponent>() != stable_type_hash<SnapshotMapComponent>());
+    REQUIRE(stable_type_hash<SparseSetStorage<int>>() != stable_type_hash<VectorStorage<int>>());
+}
+
+TEST_CASE("World snapshots round trip entities and components", "[Snapshot]") {
+    std::vector<Entity> entities(100);
+    {
+        World world;
+        world.add_component<SnapshotComponent>();
+        world.add_component<SnapshotMapComponent>();
+        world.add_component<SnapshotExtraComponent>();
+
+        world.create_entities(entities.size(), entities);
+        for (const auto e : entities) {
+            world.write_component<TransformComponent>()[e].transform[3][0] = float(e.id);
+            world.write_component<SnapshotComponent>().insert(e, { int(e.id), 0.5f * float(e.id) });
+            if (e.id % 3 == 0) world.write_component<SnapshotMapComponent>().insert(e, { -int(e.id) });
+            world.write_component<SnapshotExtraComponent>().insert(e, { 1 });
+        }
+        world.destroy_entities(std::span(entities).first(10));
+        world.save_snapshot(snapshot_path());
+    }
+
+    // SnapshotExtraComponent is not registered so its record is skipped
+    World world;
+    world.add_component<SnapshotComponent>();
+    world.add_component<SnapshotMapComponent>();
+    auto& query = world.cached_query<SnapshotComponent, SnapshotMapComponent>();
+    world.load_snapshot(snapshot_path());
+
+    const auto& components = world.read_component<SnapshotComponent>();
+    const auto& map_components = world.read_component<SnapshotMapComponent>();
+    const auto& transforms = world.read_component<TransformComponent>();
+    REQUIRE(components.size() == 90);
+    for (const auto e : std::span(entities).subspan(10)) {
+        REQUIRE(components.at(e).value == int(e.id));
+        REQUIRE(components.at(e).weight == 0.5f * float(e.id));
+        REQUIRE(transforms.at(e).transform[3][0] == float(e.id));
+        REQUIRE(map_components.contains(e) == (e.id % 3 == 0));
+    }
+    REQUIRE_FALSE(components.contains(entities[0]));
+
+    // Loaded storages ran their insert hooks
+    REQUIRE(query.size() == map_components.size());
+
+    // The allocator continues where the saved world left off
+    const auto recycled = world.create_entity();
+    REQUIRE(recycled.generation == 1);
+    REQUIRE(recycled.id <= entities[9].id);
+
+    std::filesystem::remove(snapshot_path());
+}
+
+TEST_CASE("World::load_snapshot rejects invalid files", "[Snapshot]") {
+    {
+        std::ofstream file(snapshot_path(), std::ios::binary);
+        file << "not a snapshot at all, just some text that is long enough to look like a block";
+    }
+
+    World world;
+    REQUIRE_THROWS_AS(world.load_snapshot(snapshot_path()), std::runtime_error);
+
+    std::filesystem::remove(snapshot_path());
+}
+
+TEST_CASE("SparseSetStorage::read_snapshot rejects sparse indices out of range", "[Snapshot]") {
+    SparseSetStorage<int> source;
+    source.insert(Entity(0, 1), 1);
+    source.insert(Entity(0, 2), 2);
+
+    SnapshotBuffer buffer;
+    SnapshotWriter writer(buffer);
+    // Sparse array of a storage with more entities than follow
+    writer.write_block(std::span<const uint32_t>(std::vector<uint32_t> { ~uint32_t(0), 0, 5 }));
+    writer.write_block(source.packed_entities());
+    writer.write_block(std::span<const int>(source.packed_components()));
+    writer.write_block(source.packed_ticks());
+    source.entities().write_snapshot(writer);
+
+    SparseSetStorage<int> storage;
+    SnapshotReader reader(buffer);
+    REQUIRE_THROWS_AS(storage.read_snapshot(reader), std::runtime_error);
+}
+
+TEST_CASE("VectorStorage::read_snapshot rejects entities without components", "[Snapshot]") {
+    VectorStorage<int> source;
+    source.insert(Entity(0, 0), 1);
+    source.insert(Entity(0, 3), 2);
+
+    SECTION("Truncated component block") {
+        SnapshotBuffer buffer;
+        SnapshotWriter writer(buffer);
+        writer.write_value(uint64_t(2));
+        writer.write_block(std::span<const int>(std::vector<int> { 1 }));
+        writer.write_block(std::span<const ComponentTicks>(std::vector<ComponentTicks>(1)));
+        source.entities().write_snapshot(writer);
+
+        VectorStorage<int> storage;
+        SnapshotReader reader(buffer);
+        REQUIRE_THROWS_AS(storage.read_snapshot(reader), std::runtime_error);
+    }
+
+    SECTION("Count not matching the valid entities") {
+        SnapshotBuffer buffer;
+        SnapshotWriter writer(buffer);
+        writer.write_value(uint64_t(3));
+        writer.write_block(std::span<const int>(std::vector<int>(4)));
+        writer.write_block(std::span<const ComponentTicks>(std::vector<ComponentTicks>(4)));
+        source.entities().write_snapshot(writer);
+
+        VectorStorage<int> storage;
+        SnapshotReader reader(buffer);
+        REQUIRE_THROWS_AS(storage.read_snapshot(reader), std::runtime_error);
+    }
+}
@@ -0,0 +1,117 @@
+#include <filesystem>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+
+#include "SoaStorage.h"
+#include "TransformComponent.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+struct SoaParticle {
+    using Storage = SoaStorage<SoaParticle>;
+    glm::vec3 position;
+    glm::vec3 velocity;
+    float inverse_mass = 1.0f;
+};
+EMBER_SOA_COMPONENT(SoaParticle, position, velocity, inverse_mass)
+static_assert(Component<SoaParticle>);
+static_assert(TrackedStorage<SoaStorage<SoaParticle>>);
+static_assert(HookedStorage<SoaStorage<SoaParticle>>);
+static_assert(SnapshotStorage<SoaStorage<SoaParticle>>);
+
+TEST_CASE("SoaStorage reads and writes components through proxies", "[SoaStorage]") {
+    SoaStorage<SoaParticle> storage;
+    storage.insert(3, { glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.5f });
+    storage.insert(1, { glm::vec3(4.0f, 5.0f, 6.0f), glm::vec3(), 2.0f });
+
+    REQUIRE(storage.size() == 2);
+    REQUIRE(storage.contains(3));
+    REQUIRE_FALSE(storage.contains(2));
+    REQUIRE(storage[3].position == glm::vec3(1.0f, 2.0f, 3.0f));
+    REQUIRE(storage.at(1).inverse_mass == 2.0f);
+
+    auto particle = storage[3];
+    particle.position += particle.velocity;
+    REQUIRE(storage[3].position == glm::vec3(1.0f, 3.0f, 3.0f));
+
+    const SoaParticle copy = storage[1];
+    REQUIRE(copy.position == glm::vec3(4.0f, 5.0f, 6.0f));
+    storage[3] = copy;
+    REQUIRE(storage[3].inverse_mass == 2.0f);
+    storage[1] = storage[3];
+
+    const auto& const_storage = storage;
+    REQUIRE_THROWS_AS(const_storage.at(2), std::out_of_range);
+}
+
+TEST_CASE("SoaStorage keeps fields packed when removing", "[SoaStorage]") {
+    SoaStorage<SoaParticle> storage;
+    for (uint32_t i = 0; i < 5; i++) {
+        storage.insert(i, { glm::vec3(float(i)), glm::vec3(), float(i) });
+    }
+    storage.remove(1);
+    REQUIRE_THROWS_AS(storage.remove(1), std::out_of_range);
+
+    const auto masses = storage.field<&SoaParticle::inverse_mass>();
+    const auto entities = storage.packed_entities();
+    REQUIRE(masses.size() == 4);
+    REQUIRE(entities.size() == 4);
+    for (size_t i = 0; i < masses.size(); i++) {
+        REQUIRE(masses[i] == float(entities[i].id));
+    }
+    REQUIRE(storage[4].position == glm::vec3(4.0f));
+
+    auto positions = storage.field<&SoaParticle::position>();
+    for (auto& position : positions) position = glm::vec3(0.0f);
+    for (auto particle : storage) REQUIRE(particle.position == glm::vec3(0.0f));
+
+    auto [velocities, inverse_masses] = storage.fields<&SoaParticle::velocity, &SoaParticle::inverse_mass>();
+    REQUIRE(velocities.size() == 4);
+    REQUIRE(inverse_masses.size() == 4);
+    for (size_t i = 0; i < velocities.size(); i++) velocities[i] = glm::vec3(inverse_masses[i]);
+    for (auto particle : storage) REQUIRE(particle.velocity == glm::vec3(particle.inverse_mass));
+}
+
+TEST_CASE("SoaStorage components work in world views", "[SoaStorage]") {
+    World world;
+    world.add_component<SoaParticle>();
+
+    std::vector<Entity> entities(10);
+    world.create_entities(10, entities);
+    for (const auto e : entities) {
+        world.write_component<SoaParticle>().insert(e, { glm::vec3(), glm::vec3(1.0f, 0.0f, 0.0f), 1.0f });
+    }
+
+    for (auto [e, particle, transform] : world.view<SoaParticle, const TransformComponent>()) {
+        particle.position += particle.velocity;
+    }
+
+    size_t count = 0;
+    world.view<const SoaParticle>().each([&](Entity, auto particle) {
+        REQUIRE(particle.position == glm::vec3(1.0f, 0.0f, 0.0f));
+        count++;
+    });
+    REQUIRE(count == 10);
+
+    world.destroy_entities(std::span(entities).first(5));
+    REQUIRE(world.read_component<SoaParticle>().size() == 5);
+}
+
+TEST_CASE("SoaStorage round trips through snapshots", "[SoaStorage]") {
+    World world;
+    world.add_component<SoaParticle>();
+    const auto e = world.create_entity();
+    world.write_component<SoaParticle>().insert(e, { glm::vec3(1.0f), glm::vec3(2.0f), 3.0f });
+
+    const auto path = std::filesystem::temp_directory_path() / "ember_test_soa_snapshot.bin";
+    world.save_snapshot(path);
+
+    World loaded;
+    loaded.add_component<SoaParticle>();
+    loaded.load_snapshot(path);
+    std::filesystem::remove(path);
+
+    REQUIRE(loaded.read_component<SoaParticle>().at(e).velocity == glm::vec3(2.0f));
+    REQUIRE(loaded.read_component<SoaParticle>().at(e).inverse_mass == 3.0f);
+}
@@ -1,10 +1,11 @@
 #include <catch2/catch_template_test_macros.hpp>
 
+#include "Archetype.h"
 #include "Storage.h"
 
 using namespace ember::ecs;
 
-TEMPLATE_TEST_CASE("Storage::contains() returns true iff the entity is in the storage", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>) {
+TEMPLATE_TEST_CASE("Storage::contains() returns true iff the entity is in the storage", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>, ArchetypeStorage<int>) {
     TestType storage;
     storage.insert(0, 5);
 
@@ -12,7 +13,7 @@ TEMPLATE_TEST_CASE("Storage::contains() returns true iff the entity is in the st
     REQUIRE_FALSE(storage.contains(1));
 }
 
-TEMPLATE_TEST_CASE("Storage::entities() returns entity set of the storage", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>) {
+TEMPLATE_TEST_CASE("Storage::entities() returns entity set of the storage", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>, ArchetypeStorage<int>) {
     TestType storage;
     storage.insert(0, 5);
 
@@ -21,7 +22,7 @@ TEMPLATE_TEST_CASE("Storage::entities() returns entity set of the storage", "[St
     REQUIRE_FALSE(entities.contains(1));
 }
 
-TEMPLATE_TEST_CASE("Storage::operator[] returns component reference", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>) {
+TEMPLATE_TEST_CASE("Storage::operator[] returns component reference", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>, ArchetypeStorage<int>) {
     TestType storage;
 
     storage.insert(0, 5);
@@ -32,7 +33,7 @@ TEMPLATE_TEST_CASE("Storage::operator[] returns component reference", "[Storage]
     REQUIRE(storage[0] == 6);
 }
 
-TEMPLATE_TEST_CASE("Storage::at() returns component reference if storage holds entity", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>) {
+TEMPLATE_TEST_CASE("Storage::at() returns component reference if storage holds entity", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>, ArchetypeStorage<int>) {
     TestType storage;
 
     storage.insert(0, 5);
@@ -46,20 +47,20 @@ TEMPLATE_TEST_CASE("Storage::at() returns component reference if storage holds e
     REQUIRE_THROWS_AS(storage.at(0), std::out_of_range);
 }
 
-TEMPLATE_TEST_CASE("Storage::insert() overwites existing components for the same entity", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>) {
+TEMPLATE_TEST_CASE("Storage::insert() overwites existing components for the same entity", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>, ArchetypeStorage<int>) {
     TestType storage;
     storage.insert(0, 0);
     storage.insert(0, 1);
     REQUIRE(storage[0] == 1);
 }
 
-TEMPLATE_TEST_CASE("Storage::remove() throws out_of_range if entity is not in storage", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>) {
+TEMPLATE_TEST_CASE("Storage::remove() throws out_of_range if entity is not in storage", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>, ArchetypeStorage<int>) {
     TestType storage;
     storage.insert(0, 0);
     REQUIRE_THROWS_AS(storage.remove(1), std::out_of_range);
 }
 
-TEMPLATE_TEST_CASE("Storage::begin/end() allow iteration over the components", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>) {
+TEMPLATE_TEST_CASE("Storage::begin/end() allow iteration over the components", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, ArchetypeStorage<int>) {
     TestType storage;
     for (auto i = 0; i < 10; i++) {
         storage.insert(i, i);
@@ -96,3 +97,94 @@ TEST_CASE("MapStorage::begin/end() allow iteration over the components", "[Stora
         REQUIRE(iter->second == 2*i);
     }
 }
+
+TEST_CASE("VectorStorage::insert() replaces a stale generation with a remove and an insert", "[Storage]") {
+    VectorStorage<int> storage;
+    size_t inserted = 0;
+    size_t removed = 0;
+    storage.hooks().on_insert([&](Entity) { inserted++; });
+    storage.hooks().on_remove([&](Entity) { removed++; });
+
+    storage.insert(Entity(0, 1), 1);
+    storage.insert(Entity(1, 1), 2);
+
+    REQUIRE(storage.size() == 1);
+    REQUIRE(inserted == 2);
+    REQUIRE(removed == 1);
+    REQUIRE_FALSE(storage.contains(Entity(0, 1)));
+    REQUIRE(storage.at(Entity(1, 1)) == 2);
+}
+
+TEST_CASE("SparseSetStorage::remove() keeps the remaining components addressable", "[Storage]") {
+    SparseSetStorage<int> storage;
+    for (auto i = 0; i < 10; i++) {
+        storage.insert(i, i);
+    }
+
+    storage.remove(0);
+    storage.remove(5);
+
+    REQUIRE(storage.size() == 8);
+    REQUIRE_FALSE(storage.contains(0));
+    REQUIRE_FALSE(storage.contains(5));
+    for (auto i : { 1, 2, 3, 4, 6, 7, 8, 9 }) {
+        REQUIRE(storage.at(i) == i);
+    }
+
+    const auto entities = storage.packed_entities();
+    const auto components = storage.packed_components();
+    for (auto i = 0; i < storage.size(); i++) {
+        REQUIRE(int(entities[i].id) == components[i]);
+    }
+}
+
+TEST_CASE("SparseSetStorage::contains() checks the entity generation", "[Storage]") {
+    SparseSetStorage<int> storage;
+    storage.insert(Entity(1, 3), 5);
+
+    REQUIRE(storage.contains(Entity(1, 3)));
+    REQUIRE_FALSE(storage.contains(Entity(0, 3)));
+    REQUIRE_THROWS_AS(storage.at(Entity(0, 3)), std::out_of_range);
+}
+
+TEMPLATE_TEST_CASE("Storage::insert() ignores dead handles of an older generation", "[Storage]", VectorStorage<int>, DenseVectorStorage<int>, MapStorage<int>, ArchetypeStorage<int>) {
+    TestType storage;
+    size_t inserted = 0;
+    storage.hooks().on_insert([&](Entity) { inserted++; });
+
+    storage.insert(Entity(2, 4), 1);
+    storage.insert(Entity(1, 4), 2);
+    REQUIRE(storage.size() == 1);
+    REQUIRE(inserted == 1);
+    REQUIRE_FALSE(storage.contains(Entity(1, 4)));
+    REQUIRE(storage.at(Entity(2, 4)) == 1);
+
+    // A newer generation replaces the live entity
+    storage.insert(Entity(3, 4), 3);
+    REQUIRE(storage.size() == 1);
+    REQUIRE(inserted == 2);
+    REQUIRE(storage.at(Entity(3, 4)) == 3);
+}
+
+TEST_CASE("SparseSetStorage::insert_range/remove_range insert and remove in bulk", "[Storage]") {
+    SparseSetStorage<int> storage;
+
+    std::vector<Entity> entities;
+    std::vector<int> components;
+    for (auto i = 0; i < 100; i++) {
+        entities.push_back(i);
+        components.push_back(2*i);
+    }
+
+    storage.insert_range(entities, components);
+    REQUIRE(storage.size() == 100);
+    REQUIRE(storage.at(42) == 84);
+    REQUIRE(storage.entities().contains(99));
+
+    storage.remove_range(std::span(entities).subspan(0, 50));
+    REQUIRE(storage.size() == 50);
+    REQUIRE_FALSE(storage.contains(49));
+    REQUIRE(storage.at(50) == 100);
+
+    REQUIRE_THROWS_AS(storage.insert_range(entities, std::span(components).subspan(1)), std::invalid_argument);
+}
@@ -5,8 +5,10 @@
 
 using namespace ember::ecs;
 
+// These systems touch no components, declaring so lets them share phases
 #define DEFINE_SYSTEM(name) \
 struct name {                                   \
+    using Access = ember::ecs::Access<>;        \
     static void init(World& world) { }          \
     static void run(World& world, float dt) { } \
 }
@@ -86,4 +88,109 @@ TEST_CASE("SystemGraph 3", "[SystemGraph]") {
     // Phase 3
     REQUIRE(systems.at(3).size() == 1);
     REQUIRE(systems.at(3).contains(SystemF::run));
-}
\ No newline at end of file
+}
+struct ComponentX { };
+struct ComponentY { };
+
+#define DEFINE_SYSTEM_WITH_ACCESS(name, ...)        \
+struct name {                                       \
+    using Access = ember::ecs::Access<__VA_ARGS__>; \
+    static void init(World& world) { }              \
+    static void run(World& world, float dt) { }     \
+}
+
+DEFINE_SYSTEM_WITH_ACCESS(WriterX1, Write<ComponentX>);
+DEFINE_SYSTEM_WITH_ACCESS(WriterX2, Write<ComponentX>, Read<ComponentY>);
+DEFINE_SYSTEM_WITH_ACCESS(ReaderX1, Read<ComponentX>);
+DEFINE_SYSTEM_WITH_ACCESS(ReaderX2, Read<ComponentX, ComponentY>);
+DEFINE_SYSTEM_WITH_ACCESS(WriterY, Write<ComponentY>);
+
+static_assert(System<WriterX1>);
+
+TEST_CASE("SystemGraph places systems with disjoint access in the same phase", "[SystemGraph]") {
+    SystemGraphBuilder builder;
+
+    builder.add_system<ReaderX1>();
+    builder.add_system<ReaderX2>();
+    builder.add_system<SystemA>();
+
+    auto systems = builder.build();
+
+    REQUIRE(systems.size() == 1);
+    REQUIRE(systems.at(0).size() == 3);
+}
+
+TEST_CASE("SystemGraph separates conflicting writers into phases in registration order", "[SystemGraph]") {
+    SystemGraphBuilder builder;
+
+    builder.add_system<WriterX1>();
+    builder.add_system<WriterX2>();
+    builder.add_system<WriterY>();
+    builder.add_system<ReaderX1>();
+
+    auto systems = builder.build();
+
+    REQUIRE(systems.size() == 3);
+
+    // Phase 0: WriterX1 and WriterY don't touch the same components
+    REQUIRE(systems.at(0).size() == 2);
+    REQUIRE(systems.at(0).contains(WriterX1::run));
+    REQUIRE(systems.at(0).contains(WriterY::run));
+
+    // Phase 1: WriterX2 conflicts with WriterX1 (X) and WriterY (Y)
+    REQUIRE(systems.at(1).size() == 1);
+    REQUIRE(systems.at(1).contains(WriterX2::run));
+
+    // Phase 2: ReaderX1 reads X which every earlier phase writes
+    REQUIRE(systems.at(2).size() == 1);
+    REQUIRE(systems.at(2).contains(ReaderX1::run));
+}
+
+TEST_CASE("SystemGraph keeps explicit ordering on top of access conflicts", "[SystemGraph]") {
+    SystemGraphBuilder builder;
+
+    builder.order_systems<ReaderX1, WriterY>();
+    builder.add_system<WriterX1>();
+
+    auto systems = builder.build();
+
+    REQUIRE(systems.size() == 2);
+    REQUIRE(systems.at(0).contains(ReaderX1::run));
+    REQUIRE(systems.at(1).contains(WriterY::run));
+    REQUIRE(systems.at(1).contains(WriterX1::run));
+}
+
+struct UndeclaredSystem {
+    static void init(World& world) { }
+    static void run(World& world, float dt) { }
+};
+
+TEST_CASE("SystemGraph keeps systems without declared access out of other systems' phases", "[SystemGraph]") {
+    SystemGraphBuilder builder;
+
+    builder.add_system<ReaderX1>();
+    builder.add_system<UndeclaredSystem>();
+    builder.add_system<SystemA>();
+
+    auto systems = builder.build();
+
+    REQUIRE(systems.size() == 2);
+
+    // Phase 0: SystemA declares that it touches nothing
+    REQUIRE(systems.at(0).size() == 2);
+    REQUIRE(systems.at(0).contains(ReaderX1::run));
+    REQUIRE(systems.at(0).contains(SystemA::run));
+
+    // Phase 1: UndeclaredSystem may touch anything
+    REQUIRE(systems.at(1).size() == 1);
+    REQUIRE(systems.at(1).contains(UndeclaredSystem::run));
+}
+
+TEST_CASE("SystemGraphBuilder::build() throws on ordering cycles", "[SystemGraph]") {
+    SystemGraphBuilder builder;
+
+    builder.order_systems<SystemA, SystemB>();
+    builder.order_systems<SystemB, SystemA>();
+
+    REQUIRE_THROWS_AS(builder.build(), std::logic_error);
+}
@@ -0,0 +1,181 @@
+#include <cmath>
+#include <catch2/catch_test_macros.hpp>
+#include <glm/glm.hpp>
+
+#include "SystemGraph.h"
+#include "TransformPropagationSystem.h"
+#include "World.h"
+
+using namespace ember::ecs;
+
+namespace {
+    bool approx_equal(const glm::mat4& lhs, const glm::mat4& rhs) {
+        for (auto i = 0; i < 4; i++) {
+            for (auto j = 0; j < 4; j++) {
+                if (std::abs(lhs[i][j] - rhs[i][j]) > 1e-4f) return false;
+            }
+        }
+        return true;
+    }
+
+    // Arbitrary affine transform
+    glm::mat4 make_transform(float x) {
+        auto m = glm::identity<glm::mat4>();
+        for (auto i = 0; i < 4; i++) {
+            for (auto j = 0; j < 3; j++) m[i][j] = std::sin(x + float(4 * i + j));
+        }
+        return m;
+    }
+}
+
+TEST_CASE("multiply_transforms() matches glm", "[TransformPropagationSystem]") {
+    const auto a = make_transform(0.5f);
+    auto b = make_transform(1.5f);
+    b[3][3] = 2.0f;
+
+    glm::mat4 out;
+    multiply_transforms(a, b, out);
+    REQUIRE(approx_equal(out, a * b));
+}
+
+TEST_CASE("TransformPropagationSystem composes transforms down the hierarchy", "[TransformPropagationSystem]") {
+    World world;
+    world.set_thread_pool(std::make_shared<ember::util::ThreadPool>(4));
+    TransformPropagationSystem::init(world);
+
+    // A long chain plus many roots so levels get split across threads
+    std::vector<Entity> chain(50);
+    world.create_entities(chain.size(), chain);
+    std::vector<Entity> roots(5000);
+    world.create_entities(roots.size(), roots);
+
+    auto& transforms = world.write_component<TransformComponent>();
+    auto& parents = world.write_component<ParentComponent>();
+    for (auto i = 0; i < chain.size(); i++) {
+        transforms[chain[i]].transform = make_transform(0.01f * float(i));
+        if (i > 0) parents.insert(chain[i], { chain[i-1] });
+    }
+    for (auto i = 0; i < roots.size(); i++) {
+        transforms[roots[i]].transform = make_transform(float(i));
+        if (i > 0) parents.insert(roots[i], { chain[0] });
+    }
+
+    TransformPropagationSystem::run(world, 0.1f);
+
+    const auto& hierarchy = world.read_resource<TransformHierarchy>();
+    REQUIRE(hierarchy.level_count() == chain.size());
+    REQUIRE(hierarchy.level(1).size() == roots.size());
+
+    const auto& globals = world.read_component<GlobalTransformComponent>();
+    auto expected = glm::identity<glm::mat4>();
+    for (const auto e : chain) {
+        expected = expected * transforms[e].transform;
+        REQUIRE(approx_equal(globals.at(e).transform, expected));
+    }
+    REQUIRE(approx_equal(globals.at(roots[0]).transform, transforms[roots[0]].transform));
+    REQUIRE(approx_equal(globals.at(roots[7]).transform, transforms[chain[0]].transform * transforms[roots[7]].transform));
+
+    // Reparenting rebuilds the hierarchy
+    parents[chain[1]].parent = roots[7];
+    TransformPropagationSystem::run(world, 0.1f);
+    REQUIRE(hierarchy.level_count() == chain.size() + 1);
+    REQUIRE(approx_equal(
+        globals.at(chain[1]).transform,
+        transforms[chain[0]].transform * transforms[roots[7]].transform * transforms[chain[1]].transform
+    ));
+}
+
+TEST_CASE("TransformPropagationSystem rejects cycles", "[TransformPropagationSystem]") {
+    World world;
+    TransformPropagationSystem::init(world);
+
+    const auto a = world.create_entity();
+    const auto b = world.create_entity();
+    world.write_component<ParentComponent>().insert(a, { b });
+    world.write_component<ParentComponent>().insert(b, { a });
+    REQUIRE_THROWS_AS(TransformPropagationSystem::run(world, 0.1f), std::logic_error);
+}
+
+TEST_CASE("TransformPropagationSystem skips unchanged subtrees", "[TransformPropagationSystem]") {
+    SystemGraphBuilder builder;
+    builder.add_system<TransformPropagationSystem>();
+    World world(builder.build());
+    TransformPropagationSystem::init(world);
+
+    const auto root = world.create_entity();
+    const auto child = world.create_entity();
+    const auto other = world.create_entity();
+    world.write_component<ParentComponent>().insert(child, { root });
+    world.run(0.1f);
+
+    const auto& globals = world.read_component<GlobalTransformComponent>();
+    const auto child_tick = globals.ticks(child).changed;
+    const auto other_tick = globals.ticks(other).changed;
+
+    world.write_component<TransformComponent>()[root].transform = make_transform(1.0f);
+    world.run(0.1f);
+
+    REQUIRE(globals.ticks(child).changed != child_tick);
+    REQUIRE(globals.ticks(other).changed == other_tick);
+    REQUIRE(approx_equal(globals.at(child).transform, make_transform(1.0f)));
+}
+
+TEST_CASE("TransformHierarchy follows spawns, reparenting and destruction incrementally", "[TransformPropagationSystem]") {
+    World world;
+    TransformPropagationSystem::init(world);
+
+    std::vector<Entity> chain(3);
+    world.create_entities(chain.size(), chain);
+    auto& transforms = world.write_component<TransformComponent>();
+    auto& parents = world.write_component<ParentComponent>();
+    for (auto i = 0; i < chain.size(); i++) {
+        transforms[chain[i]].transform = make_transform(float(i));
+        if (i > 0) parents.insert(chain[i], { chain[i-1] });
+    }
+    TransformPropagationSystem::run(world, 0.1f);
+
+    const auto& hierarchy = world.read_resource<TransformHierarchy>();
+    const auto& globals = world.read_component<GlobalTransformComponent>();
+    REQUIRE(hierarchy.level_count() == 3);
+
+    // A spawned leaf lands one level below its parent
+    const auto leaf = world.create_entity();
+    transforms[leaf].transform = make_transform(5.0f);
+    parents.insert(leaf, { chain[2] });
+    TransformPropagationSystem::run(world, 0.1f);
+    REQUIRE(hierarchy.level_count() == 4);
+    REQUIRE(approx_equal(
+        globals.at(leaf).transform,
+        transforms[chain[0]].transform * transforms[chain[1]].transform * transforms[chain[2]].transform * transforms[leaf].transform
+    ));
+
+    // Moving a subtree moves its descendants too
+    parents.insert(chain[2], { chain[0] });
+    TransformPropagationSystem::run(world, 0.1f);
+    REQUIRE(hierarchy.level_count() == 3);
+    REQUIRE(approx_equal(
+        globals.at(leaf).transform,
+        transforms[chain[0]].transform * transforms[chain[2]].transform * transforms[leaf].transform
+    ));
+
+    // Children of a destroyed entity become roots
+    world.destroy_entity(chain[0]);
+    TransformPropagationSystem::run(world, 0.1f);
+    REQUIRE_FALSE(globals.contains(chain[0]));
+    REQUIRE(hierarchy.level(0).size() == 3); // the world origin, chain[1] and chain[2]
+    REQUIRE(approx_equal(globals.at(leaf).transform, transforms[chain[2]].transform * transforms[leaf].transform));
+}
+
+TEST_CASE("TransformHierarchy removes its hooks when destroyed", "[TransformPropagationSystem]") {
+    TransformComponent::Storage transforms;
+    ParentComponent::Storage parents;
+    {
+        TransformHierarchy hierarchy;
+        hierarchy.attach(transforms, parents);
+        REQUIRE_FALSE(transforms.hooks().empty());
+        REQUIRE_FALSE(parents.hooks().empty());
+    }
+    REQUIRE(transforms.hooks().empty());
+    REQUIRE(parents.hooks().empty());
+    transforms.insert(1, {});
+}
@@ -1,6 +1,8 @@
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
 
 #include "Storage.h"
+#include "TransformComponent.h"
 #include "World.h"
 
 using namespace ember::ecs;
@@ -26,7 +28,57 @@ TEST_CASE("World::create_entity returns new or recycled entity", "[World]") {
 
     world.destroy_entity(e0);
     auto e0_1 = world.create_entity();
-    REQUIRE(e0_1 == (e0.generation++));
+    REQUIRE(e0_1.id == e0.id);
+    REQUIRE(e0_1.generation == e0.generation + 1);
+}
+
+TEST_CASE("World::destroy_entities strips components from every storage", "[World]") {
+    World world;
+    world.add_component<TestComponent>();
+    world.add_component<TestComponent2>();
+
+    std::vector<Entity> entities(100);
+    world.create_entities(entities.size(), entities);
+    for (const auto e : entities) {
+        world.write_component<TestComponent>().insert(e, { int(e.id) });
+        if (e.id % 2) world.write_component<TestComponent2>().insert(e, { int(e.id) });
+    }
+
+    world.destroy_entities(std::span(entities).first(50));
+    REQUIRE(world.read_component<TestComponent>().size() == 50);
+    REQUIRE(world.read_component<TestComponent2>().size() == 25);
+    REQUIRE_FALSE(world.read_component<TransformComponent>().contains(entities[0]));
+    REQUIRE(world.read_component<TransformComponent>().contains(entities[50]));
+
+    // Recycled ids come back with a new generation and no stale components
+    std::vector<Entity> recycled(60);
+    world.create_entities(recycled.size(), recycled);
+    for (const auto e : recycled) {
+        REQUIRE_FALSE(world.read_component<TestComponent>().contains(e));
+        REQUIRE(world.read_component<TransformComponent>().contains(e));
+    }
+    REQUIRE(std::count_if(recycled.begin(), recycled.end(), [](Entity e) { return e.generation == 1; }) == 50);
+
+    REQUIRE_THROWS_AS(world.create_entities(10, std::span(recycled).first(5)), std::invalid_argument);
+}
+
+TEST_CASE("World::destroy_entities skips entities that are no longer alive", "[World]") {
+    World world;
+
+    std::vector<Entity> entities(4);
+    world.create_entities(entities.size(), entities);
+
+    world.destroy_entity(entities[0]);
+    world.destroy_entity(entities[0]);
+    world.destroy_entities(std::vector<Entity> { entities[1], entities[1], entities[2] });
+
+    // Each id was recycled exactly once
+    std::vector<Entity> recycled(4);
+    world.create_entities(recycled.size(), recycled);
+    std::sort(recycled.begin(), recycled.end());
+    REQUIRE(std::adjacent_find(recycled.begin(), recycled.end()) == recycled.end());
+    REQUIRE(std::count_if(recycled.begin(), recycled.end(), [](Entity e) { return e.generation == 1; }) == 3);
+    REQUIRE(world.read_component<TransformComponent>().contains(entities[3]));
 }
 
 TEST_CASE("World::query", "[World]") {
@@ -44,4 +96,139 @@ TEST_CASE("World::query", "[World]") {
     const auto query = world.query<TestComponent, TestComponent2>();
     REQUIRE(query.contains(0));
     REQUIRE_FALSE(query.contains(1));
-}
\ No newline at end of file
+}
+TEST_CASE("World::view yields entities holding every component", "[World]") {
+    World world;
+    world.add_component<TestComponent>();
+    world.add_component<TestComponent2>();
+
+    auto& t0 = world.write_component<TestComponent>();
+    auto& t1 = world.write_component<TestComponent2>();
+    for (auto i = 0; i < 10; i++) {
+        t0.insert(i, {i});
+        if (i % 3 == 0) t1.insert(i, {10*i});
+    }
+
+    std::vector<Entity> entities;
+    for (auto [e, c0, c1] : world.view<TestComponent, const TestComponent2>()) {
+        entities.push_back(e);
+        c0.value += c1.value;
+    }
+
+    REQUIRE(entities.size() == 4);
+    REQUIRE(t0.at(3).value == 33);
+    REQUIRE(t0.at(4).value == 4);
+}
+
+TEST_CASE("World::view drives iteration from the smallest storage", "[World]") {
+    World world;
+    world.add_component<TestComponent>();
+
+    std::vector<Entity> entities;
+    for (auto i = 0; i < 10; i++) entities.push_back(world.create_entity());
+    world.write_component<TestComponent>().insert(entities[5], {5});
+
+    // TransformComponent holds every entity, TestComponent only one
+    const auto view = world.view<const TestComponent, const TransformComponent>();
+    REQUIRE(view.size_hint() == 1);
+
+    size_t count = 0;
+    view.each([&](Entity e, const TestComponent& c, const TransformComponent&) {
+        REQUIRE(e == entities[5]);
+        REQUIRE(c.value == 5);
+        count++;
+    });
+    REQUIRE(count == 1);
+}
+
+namespace {
+    std::atomic<int> s_parallel_runs = 0;
+
+    struct ParallelSystemA {
+        using Access = ember::ecs::Access<>;
+        static void init(World&) { }
+        static void run(World&, float) { s_parallel_runs++; }
+    };
+    struct ParallelSystemB {
+        using Access = ember::ecs::Access<>;
+        static void init(World&) { }
+        static void run(World&, float) { s_parallel_runs++; }
+    };
+    struct ParallelSystemC {
+        static void init(World&) { }
+        static void run(World&, float) {
+            // Phase barrier: both systems of the previous phase already ran
+            REQUIRE(s_parallel_runs == 2);
+            s_parallel_runs++;
+        }
+    };
+}
+
+TEST_CASE("World::run executes phases on the thread pool with a barrier in between", "[World]") {
+    SystemGraphBuilder builder;
+    builder.order_systems<ParallelSystemA, ParallelSystemC>();
+    builder.order_systems<ParallelSystemB, ParallelSystemC>();
+
+    World world(builder.build());
+    world.set_thread_pool(std::make_shared<ember::util::ThreadPool>(4));
+
+    s_parallel_runs = 0;
+    world.run(0.1f);
+    REQUIRE(s_parallel_runs == 3);
+}
+
+TEST_CASE("World::run records runs, phases and systems with a profiler", "[World]") {
+    SystemGraphBuilder builder;
+    builder.order_systems<ParallelSystemA, ParallelSystemC>();
+    builder.order_systems<ParallelSystemB, ParallelSystemC>();
+
+    World world(builder.build());
+    world.set_thread_pool(std::make_shared<ember::util::ThreadPool>(4));
+    auto profiler = std::make_shared<ember::util::Profiler>();
+    world.set_profiler(profiler);
+
+    for (auto i = 0; i < 3; i++) {
+        s_parallel_runs = 0;
+        world.run(0.1f);
+    }
+
+    REQUIRE(system_name(ParallelSystemA::run).ends_with("ParallelSystemA"));
+    REQUIRE(profiler->stats("World::run").samples == 3);
+    REQUIRE(profiler->stats("phase 0").samples == 3);
+    REQUIRE(profiler->stats("phase 1").samples == 3);
+    REQUIRE(profiler->stats(system_name(ParallelSystemA::run)).samples == 3);
+    REQUIRE(profiler->stats(system_name(ParallelSystemC::run)).samples == 3);
+
+    world.set_profiler(nullptr);
+    s_parallel_runs = 0;
+    world.run(0.1f);
+    REQUIRE(profiler->stats("World::run").samples == 3);
+}
+
+TEST_CASE("type_name() names the type", "[World]") {
+    REQUIRE(type_name<TestComponent>() == "TestComponent");
+    REQUIRE(type_name<ember::ecs::TransformComponent>().ends_with("TransformComponent"));
+}
+
+TEST_CASE("type_id() is dense and shared between const and non-const types", "[World]") {
+    struct TypeA { };
+    struct TypeB { };
+
+    const auto a = type_id<TypeA>();
+    const auto b = type_id<TypeB>();
+    REQUIRE(a != b);
+    REQUIRE(type_id<const TypeA>() == a);
+    REQUIRE(type_id<TypeA>() == a);
+}
+
+TEST_CASE("World resources are looked up by type", "[World]") {
+    World world;
+    REQUIRE_THROWS_AS(world.read_resource<std::vector<int>>(), std::out_of_range);
+
+    world.add_resource(std::vector<int> { 1, 2, 3 });
+    world.add_resource(std::vector<int> { 4 });
+    REQUIRE(world.read_resource<std::vector<int>>().size() == 3);
+
+    world.write_resource<std::vector<int>>().push_back(4);
+    REQUIRE(world.read_resource<std::vector<int>>().back() == 4);
+}
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <memory>
+#include <catch2/catch_test_macros.hpp>
+
+#include "SystemGraph.h"
+#include "World.h"
+#include "WorldPool.h"
+#include "ember/util/Log.h"
+
+using namespace ember::ecs;
+
+namespace {
+    struct PoolCounter {
+        std::atomic<int> runs = 0;
+    };
+
+    struct PoolCountingSystem {
+        static void init(World&) { }
+        static void run(World& world, float) {
+            world.write_resource<std::shared_ptr<PoolCounter>>()->runs++;
+            ember::util::log(ember::util::get_current_logger(), { "pool", ember::util::LogLevel::Info, "", "", 0 }, "run");
+        }
+    };
+
+    struct PoolThrowingSystem {
+        static void init(World&) { }
+        static void run(World&, float) { throw std::runtime_error("world failed"); }
+    };
+
+    class CountingLogger final : public ember::util::Logger {
+    public:
+        std::atomic<int> messages = 0;
+        virtual void write(const ember::util::LogManifest&, const std::string&) override { messages++; }
+    };
+}
+
+TEST_CASE("WorldPool steps every world once per step", "[WorldPool]") {
+    SystemGraphBuilder builder;
+    builder.add_system<PoolCountingSystem>();
+    const auto graph = builder.build();
+
+    WorldPool pool(std::make_shared<ember::util::ThreadPool>(4));
+    std::vector<std::shared_ptr<PoolCounter>> counters;
+    std::vector<std::shared_ptr<CountingLogger>> loggers;
+    std::vector<WorldPool::WorldId> ids;
+    for (auto i = 0; i < 16; i++) {
+        auto world = std::make_shared<World>(graph);
+        counters.push_back(std::make_shared<PoolCounter>());
+        world->add_resource(counters.back());
+        loggers.push_back(std::make_shared<CountingLogger>());
+        world->set_logger(loggers.back());
+        ids.push_back(pool.add(world));
+    }
+    REQUIRE(pool.size() == 16);
+    REQUIRE(pool.world(ids[3]).thread_pool() == pool.thread_pool());
+
+    pool.run(0.1f, 5);
+    for (auto i = 0; i < 16; i++) {
+        REQUIRE(counters[i]->runs == 5);
+        // Every world logged to its own logger, whichever thread ran it
+        REQUIRE(loggers[i]->messages == 5);
+        REQUIRE(pool.stats(ids[i]).runs == 5);
+        REQUIRE(pool.stats(ids[i]).total >= pool.stats(ids[i]).last);
+    }
+
+    pool.remove(ids[0]);
+    REQUIRE(pool.size() == 15);
+    REQUIRE_THROWS_AS(pool.world(ids[0]), std::out_of_range);
+
+    pool.run(0.1f);
+    REQUIRE(counters[0]->runs == 5);
+    REQUIRE(counters[1]->runs == 6);
+}
+
+TEST_CASE("WorldPool rethrows once the step is over", "[WorldPool]") {
+    SystemGraphBuilder counting;
+    counting.add_system<PoolCountingSystem>();
+    SystemGraphBuilder throwing;
+    throwing.add_system<PoolThrowingSystem>();
+
+    WorldPool pool(std::make_shared<ember::util::ThreadPool>(2));
+    auto counter = std::make_shared<PoolCounter>();
+    auto world = std::make_shared<World>(counting.build());
+    world->add_resource(counter);
+    pool.add(world);
+    pool.add(std::make_shared<World>(throwing.build()));
+
+    REQUIRE_THROWS_AS(pool.run(0.1f), std::runtime_error);
+    REQUIRE(counter->runs == 1);
+}
+
+TEST_CASE("WorldPool runs inline without a thread pool", "[WorldPool]") {
+    SystemGraphBuilder builder;
+    builder.add_system<PoolCountingSystem>();
+
+    WorldPool pool(nullptr);
+    auto counter = std::make_shared<PoolCounter>();
+    auto world = std::make_shared<World>(builder.build());
+    world->add_resource(counter);
+    pool.add(world);
+
+    pool.run(0.1f, 3);
+    REQUIRE(counter->runs == 3);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "ember/ecs/Entity.h"
+#include "ember/ecs/World.h"
+
+namespace ember::graphics {
+
+    // Read-only copy of the render state of a world for one frame. The renderer only
+    // ever looks at packets, so it can draw frame N on its own thread while the
+    // simulation is already writing frame N+1 into the storages.
+    struct FramePacket {
+        struct MeshInstance {
+            ecs::Entity entity;
+            uint64_t mesh_id;
+            glm::mat4 transform;
+        };
+
+        struct Camera {
+            ecs::Entity entity;
+            glm::mat4 view;
+            glm::mat4 projection;
+            vk::Viewport viewport;
+        };
+
+        uint64_t frame = 0;
+        float dt = 0.0f;
+        // Fraction of a fixed simulation step elapsed since the simulated state, to
+        // interpolate towards when rendering. Always 1 with a variable timestep.
+        float alpha = 1.0f;
+        std::vector<MeshInstance> meshes;
+        std::vector<Camera> cameras;
+
+        void clear();
+
+        // Copy the transforms, meshes and cameras out of the world. The vectors keep
+        // their capacity so a packet that is reused every frame stops allocating.
+        void extract(const ecs::World& world, uint64_t frame_index, float frame_dt);
+    };
+
+    // Hands frame packets from the simulation thread to the render thread. The
+    // simulation fills back() while the renderer reads the packet it acquired, and a
+    // third packet holds the latest published frame in between, so neither side ever
+    // waits on the other. A packet the renderer did not get to in time is replaced by
+    // the next publish() so it always draws the latest state.
+    class FramePacketBuffer {
+    public:
+        FramePacketBuffer() = default;
+        FramePacketBuffer(const FramePacketBuffer&) = delete;
+        FramePacketBuffer& operator=(const FramePacketBuffer&) = delete;
+
+        // Simulation thread only
+        inline FramePacket& back() { return m_packets[m_back]; }
+
+        // Whether a renderer ever acquired a packet. Until then nobody reads them so
+        // the simulation can skip extracting.
+        inline bool has_consumer() const { return m_has_consumer.load(std::memory_order_relaxed); }
+
+        // Make back() the packet the renderer acquires next. Never blocks, a pending
+        // packet the renderer has not acquired yet becomes the new back buffer.
+        void publish();
+
+        // Block until a packet newer than the last one acquired is published. Returns
+        // nullptr once the buffer is closed. The packet stays valid until the next
+        // acquire() or try_acquire(). Marks the buffer as consumed, see has_consumer().
+        const FramePacket* acquire();
+
+        // Non-blocking acquire(), returns nullptr if nothing new was published
+        const FramePacket* try_acquire();
+
+        // Wake up a renderer blocked in acquire() so its thread can exit
+        void close();
+
+    private:
+        std::array<FramePacket, 3> m_packets;
+        size_t m_back = 0;
+        size_t m_pending = 1;
+        size_t m_front = 2;
+        bool m_published = false;
+        bool m_closed = false;
+        std::atomic<bool> m_has_consumer = false;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+    };
+
+}
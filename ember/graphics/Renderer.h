@@ -2,6 +2,7 @@
 
 #include <array>
 
+#include "FramePacket.h"
 #include "Mesh.h"
 #include "Renderpass.h"
 #include "Window.h"
@@ -27,7 +28,11 @@ namespace ember::graphics {
         inline Window* window() { return m_window.get(); }
         inline const Window* window() const { return m_window.get(); }
 
+        // Extract a packet from the world and render it, for when simulation and
+        // rendering share a thread
         void render(ecs::World& world);
+        // Safe to call from a render thread while the world keeps running
+        void render(const FramePacket& packet);
 
         // Draw Commands
         void draw_mesh(uint64_t mesh_id, const glm::mat4& transform);
@@ -39,6 +44,7 @@ namespace ember::graphics {
 
         std::vector<std::unique_ptr<Renderpass>> m_renderpasses;
         Renderpass::RenderpassObjects m_renderpass_objects;
+        FramePacket m_frame_packet;
         util::ResourceManager<Mesh> m_mesh_manager;
     };
     static_assert(ecs::System<Renderer>);
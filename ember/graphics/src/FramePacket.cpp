@@ -0,0 +1,85 @@
+#include "FramePacket.h"
+
+#include <utility>
+
+#include <glm/ext/matrix_transform.hpp>
+
+#include "CameraComponent.h"
+#include "MeshComponent.h"
+
+#include "ember/ecs/TransformComponent.h"
+
+namespace ember::graphics {
+
+    void FramePacket::clear() {
+        meshes.clear();
+        cameras.clear();
+    }
+
+    void FramePacket::extract(const ecs::World& world, uint64_t frame_index, float frame_dt) {
+        clear();
+        frame = frame_index;
+        dt = frame_dt;
+
+        const auto& transforms = world.read_component<ecs::TransformComponent>();
+        if (world.has_component<MeshComponent>()) {
+            meshes.reserve(world.read_component<MeshComponent>().size());
+            for (auto [e, mesh, transform] : world.view<const MeshComponent, const ecs::TransformComponent>()) {
+                meshes.push_back({ e, mesh.mesh_id, transform.transform });
+            }
+        }
+
+        if (!world.has_component<CameraComponent>()) return;
+        for (auto [e, camera] : world.read_component<CameraComponent>()) {
+            if (!transforms.contains(e)) continue;
+
+            const auto& camera_transform = transforms.at(e).transform;
+            glm::mat4 view;
+            if (transforms.contains(camera.focal_point)) {
+                const auto eye = glm::vec3(camera_transform[3]);
+                const auto center = glm::vec3(transforms.at(camera.focal_point).transform[3]);
+                view = glm::lookAt(eye, center, CameraComponent::UP_VECTOR);
+            } else {
+                view = glm::inverse(camera_transform);
+            }
+            cameras.push_back({ e, view, camera.projection, camera.viewport });
+        }
+    }
+
+    void FramePacketBuffer::publish() {
+        {
+            std::lock_guard lock(m_mutex);
+            std::swap(m_back, m_pending);
+            m_published = true;
+        }
+        m_cv.notify_all();
+    }
+
+    const FramePacket* FramePacketBuffer::acquire() {
+        m_has_consumer.store(true, std::memory_order_relaxed);
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_published || m_closed; });
+        if (m_closed) return nullptr;
+        std::swap(m_front, m_pending);
+        m_published = false;
+        return &m_packets[m_front];
+    }
+
+    const FramePacket* FramePacketBuffer::try_acquire() {
+        m_has_consumer.store(true, std::memory_order_relaxed);
+        std::lock_guard lock(m_mutex);
+        if (!m_published || m_closed) return nullptr;
+        std::swap(m_front, m_pending);
+        m_published = false;
+        return &m_packets[m_front];
+    }
+
+    void FramePacketBuffer::close() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_closed = true;
+        }
+        m_cv.notify_all();
+    }
+
+}
@@ -34,13 +34,21 @@ namespace ember::graphics {
     }
 
     void Renderer::render(ecs::World& world) {
+        m_frame_packet.extract(world, m_frame_packet.frame + 1, 0.0f);
+        render(m_frame_packet);
+    }
+
+    void Renderer::render(const FramePacket& packet) {
         auto gpu_interface = m_gpu_interface.get();
-        auto& cameras = world.read_component<CameraComponent>();
-        for (auto [e, camera] : cameras) {
+        for (const auto& camera : packet.cameras) {
+            const auto view_projection = camera.projection * camera.view;
+
             for (auto& renderpass : m_renderpasses) {
                 m_renderpass_objects = renderpass->begin(gpu_interface);
 
-                // Run every system?
+                for (const auto& mesh : packet.meshes) {
+                    draw_mesh(mesh.mesh_id, view_projection * mesh.transform);
+                }
 
                 renderpass->end(gpu_interface);
             }
@@ -1,14 +1,19 @@
 #pragma once
 
+#include "RigidBodyComponent.h"
 #include "ember/ecs/System.h"
+#include "ember/ecs/TransformComponent.h"
 #include "ember/ecs/World.h"
 
 namespace ember::physics {
 
     class RigidBodySystem {
     public:
+        using Access = ecs::Access<ecs::Read<ecs::TransformComponent>, ecs::Write<RigidBodyComponent>>;
+
         static void init(ecs::World& world);
         static void run(ecs::World& world, float dt);
     };
+    static_assert(ecs::System<RigidBodySystem>);
 
 }
\ No newline at end of file
@@ -14,7 +14,7 @@ namespace ember::physics {
 
     namespace {
         struct ParticleContact {
-            ParticleComponent& p1, p2;
+            ParticleComponent::Storage::reference p1, p2;
             geometry::IntersectInfo contact;
             float cor;
         };
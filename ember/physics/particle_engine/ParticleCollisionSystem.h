@@ -1,11 +1,14 @@
 #pragma once
 
+#include "ParticleComponent.h"
 #include "ember/ecs/System.h"
 
 namespace ember::physics {
 
     class ParticleCollisionSystem {
     public:
+        using Access = ecs::Access<ecs::Write<ParticleComponent>>;
+
         static void init(ecs::World& world);
         static void run(ecs::World& world, float dt);
     };
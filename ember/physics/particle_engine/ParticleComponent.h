@@ -3,12 +3,14 @@
 #include <glm/glm.hpp>
 
 #include "ember/ecs/Component.h"
-#include "ember/ecs/Storage.h"
+#include "ember/ecs/SoaStorage.h"
 
 namespace ember::physics {
 
+    // Stored as a structure of arrays: the integrator streams position, velocity and
+    // acceleration without dragging the rest of the particle through the cache
     struct ParticleComponent {
-        using Storage = ecs::DenseVectorStorage<ParticleComponent>;
+        using Storage = ecs::SoaStorage<ParticleComponent>;
 
         float inverse_mass = 1.0f;
 
@@ -19,5 +21,11 @@ namespace ember::physics {
 
         glm::vec3 applied_forces;
     };
-    static_assert(ecs::Component<ParticleComponent>);
-}
\ No newline at end of file
+
+}
+
+EMBER_SOA_COMPONENT(
+    ember::physics::ParticleComponent,
+    inverse_mass, position, velocity, acceleration, damping, applied_forces
+)
+static_assert(ember::ecs::Component<ember::physics::ParticleComponent>);
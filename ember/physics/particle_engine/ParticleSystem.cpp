@@ -1,8 +1,10 @@
 #include "ParticleSystem.h"
 
 #include <cassert>
+#include <utility>
 
 #include "ParticleComponent.h"
+#include "ember/ecs/Parallel.h"
 #include "ember/ecs/World.h"
 #include "ember/geometry/Intersect.h"
 
@@ -11,32 +13,36 @@ namespace ember::physics {
         world.add_component<ParticleComponent>();
     }
 
-    namespace {
-        void update_particle(ParticleComponent& particle, float dt) {
-            if (particle.inverse_mass <= 0.0) return;
-
-            particle.position += particle.velocity * dt;
-
-            particle.acceleration += particle.applied_forces * particle.inverse_mass;
-            particle.applied_forces = glm::vec3();
-
-            // There's a bit of an error in the book here it would appear.
-            // It states velocity should be v' = v*(damping^dt) + a*t
-            // but the code listng applies damping after adding acceleration
-            // I'm following the code listing because it probably doesn't matter
-            // much, but interesting nonetheless.
-            particle.velocity += (particle.acceleration * dt);
-            particle.velocity *= std::powf(particle.damping, dt);
-        }
-    }
-
     void ParticleSystem::run(ecs::World& world, float dt) {
         assert(dt > 0.0f);
 
         auto& particles = world.write_component<ParticleComponent>();
-
-        for (auto& particle : particles) {
-            update_particle(particle, dt);
-        }
+        const auto inverse_mass = std::as_const(particles).field<&ParticleComponent::inverse_mass>();
+        const auto damping = std::as_const(particles).field<&ParticleComponent::damping>();
+        const auto [position, velocity, acceleration, applied_forces] = particles.fields<
+            &ParticleComponent::position,
+            &ParticleComponent::velocity,
+            &ParticleComponent::acceleration,
+            &ParticleComponent::applied_forces
+        >();
+
+        ecs::parallel_for(world.thread_pool(), particles.size(), ecs::DEFAULT_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; i++) {
+                if (inverse_mass[i] <= 0.0) continue;
+
+                position[i] += velocity[i] * dt;
+
+                acceleration[i] += applied_forces[i] * inverse_mass[i];
+                applied_forces[i] = glm::vec3();
+
+                // There's a bit of an error in the book here it would appear.
+                // It states velocity should be v' = v*(damping^dt) + a*t
+                // but the code listng applies damping after adding acceleration
+                // I'm following the code listing because it probably doesn't matter
+                // much, but interesting nonetheless.
+                velocity[i] += (acceleration[i] * dt);
+                velocity[i] *= std::powf(damping[i], dt);
+            }
+        });
     }
 }
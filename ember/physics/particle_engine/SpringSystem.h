@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ParticleComponent.h"
 #include "ember/ecs/Component.h"
 #include "ember/ecs/Entity.h"
 #include "ember/ecs/Storage.h"
@@ -19,6 +20,8 @@ namespace ember::physics {
 
     class SpringSystem {
     public:
+        using Access = ecs::Access<ecs::Read<SpringComponent>, ecs::Write<ParticleComponent>>;
+
         static void init(ecs::World& world);
         static void run(ecs::World& world, float dt);
     };
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "RigidBodyComponent.h"
+#include "ember/ecs/Parallel.h"
 #include "ember/ecs/TransformComponent.h"
 
 namespace ember::physics {
@@ -38,12 +39,13 @@ namespace ember::physics {
     void RigidBodySystem::run(ecs::World& world, float dt) {
         assert(dt > 0.0f);
 
-        auto& rigid_bodies = world.write_component<RigidBodyComponent>();
-        const auto& transforms = world.read_component<ecs::TransformComponent>();
-
-        for (auto& rigid_body : rigid_bodies) {
-            update_rigid_body(rigid_body, transforms.at(0), dt); // FIXME component iteration
-        }
+        ecs::parallel_for_each(
+            world.thread_pool(),
+            world.view<RigidBodyComponent, const ecs::TransformComponent>(),
+            [dt](ecs::Entity, RigidBodyComponent& rigid_body, const ecs::TransformComponent& transform) {
+                update_rigid_body(rigid_body, transform, dt);
+            }
+        );
     }
 
 
@@ -1,5 +1,7 @@
 #include "Ember.h"
 
+#include <string_view>
+
 #include <SDL3/SDL.h>
 
 #include "ember/gpu/GPUResource.h"
@@ -23,6 +25,14 @@ namespace ember {
             gpu_app_info.version = app_info.version;
             return gpu_app_info;
         }
+
+        bool is_headless(int argc, char* argv[], const AppInfo& app_info) {
+            if (app_info.headless) return true;
+            for (auto i = 1; i < argc; i++) {
+                if (std::string_view(argv[i]) == "--headless") return true;
+            }
+            return false;
+        }
     }
 
     Ember::Ember(
@@ -32,23 +42,59 @@ namespace ember {
         std::unique_ptr<core::Scene> first_scene
     ):
         m_argc(argc), m_argv(argv),
-        m_vulkan_instance(gpu::VulkanInstance::create(make_gpu_app_info(app_info))),
+        m_headless(is_headless(argc, argv, app_info)),
+        m_frame_limiter(util::FrameLimiter::from_frame_rate(app_info.max_frame_rate)),
+        m_thread_pool(std::make_shared<util::ThreadPool>(app_info.worker_threads)),
         m_scene_manager(std::move(first_scene))
 
     {
         info(EMBER_LOG, "Hello, Ember");
-        gpu::GPUResource::vulkan_instance = m_vulkan_instance;
+        if (m_headless) {
+            info(EMBER_LOG, "Running headless");
+            m_frame_packets.close();
+        } else {
+            m_vulkan_instance = gpu::VulkanInstance::create(make_gpu_app_info(app_info));
+            gpu::GPUResource::vulkan_instance = m_vulkan_instance;
+        }
+        if (app_info.fixed_timestep > 0.0f) {
+            m_fixed_timestep.emplace(app_info.fixed_timestep, app_info.max_substeps);
+        }
     }
 
     int Ember::run() {
+        m_last_world_update = std::chrono::steady_clock::now();
         while(m_scene_manager.current_scene()) {
-            const auto current_time = std::chrono::high_resolution_clock::now();
+            const auto current_time = std::chrono::steady_clock::now();
             std::chrono::duration<float, std::chrono::seconds::period> dt = current_time - m_last_world_update;
+            m_last_world_update = current_time;
 
-            m_scene_manager.current_scene()->world().run(dt.count());
+            auto& world = m_scene_manager.current_scene()->world();
+            if (world.thread_pool() != m_thread_pool.get()) world.set_thread_pool(m_thread_pool);
 
-            m_last_world_update = current_time;
+            auto alpha = 1.0f;
+            if (m_fixed_timestep) {
+                const auto steps = m_fixed_timestep->advance(dt.count());
+                for (size_t i = 0; i < steps; i++) {
+                    world.run(m_fixed_timestep->step());
+                }
+                alpha = m_fixed_timestep->alpha();
+            } else {
+                world.run(dt.count());
+            }
+
+            // The renderer draws this frame while the next one is simulated. Nothing is
+            // extracted until a render thread starts acquiring packets.
+            m_frame++;
+            if (!m_headless && m_frame_packets.has_consumer()) {
+                auto& packet = m_frame_packets.back();
+                packet.extract(world, m_frame, dt.count());
+                packet.alpha = alpha;
+                m_frame_packets.publish();
+            }
+
+            m_frame_limiter.wait();
         }
+        m_frame_packets.close();
 
         return 0;
     }
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace ember::util {
+
+    // Accumulator turning variable frame times into a whole number of fixed steps,
+    // so the simulation advances by the same dt every time whatever the frame rate.
+    // The time left over is exposed as alpha() to interpolate between the last two
+    // simulated states when rendering.
+    class FixedTimestep {
+    public:
+        explicit FixedTimestep(float step, size_t max_substeps = 8);
+
+        inline float step() const { return m_step; }
+        inline size_t max_substeps() const { return m_max_substeps; }
+
+        // Add the time elapsed since the last frame and return the number of steps to
+        // simulate. When more than max_substeps are due the extra time is dropped so a
+        // long hitch slows the simulation down instead of making every later frame
+        // run late catching up.
+        size_t advance(float dt);
+
+        // Fraction of a step accumulated but not yet simulated, in [0, 1)
+        inline float alpha() const { return m_accumulator / m_step; }
+
+        inline void reset() { m_accumulator = 0.0f; }
+
+    private:
+        float m_step;
+        size_t m_max_substeps;
+        float m_accumulator = 0.0f;
+    };
+
+    // Caps the frame rate by waiting out the rest of every frame. Sleeping is only
+    // accurate to the scheduler granularity, so it sleeps until a little before the
+    // deadline and spins the rest of the way.
+    class FrameLimiter {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr auto DEFAULT_SPIN_TIME = std::chrono::microseconds(1500);
+
+        // A frame time of zero disables the limiter
+        explicit FrameLimiter(
+            Clock::duration frame_time = Clock::duration::zero(),
+            Clock::duration spin_time = DEFAULT_SPIN_TIME
+        );
+
+        static FrameLimiter from_frame_rate(float frames_per_second);
+
+        inline Clock::duration frame_time() const { return m_frame_time; }
+
+        // Block until the current frame has lasted frame_time. A frame that already
+        // ran over starts the next one immediately, without trying to catch up.
+        void wait();
+
+    private:
+        Clock::duration m_frame_time;
+        Clock::duration m_spin_time;
+        Clock::time_point m_deadline;
+    };
+
+}
@@ -2,6 +2,7 @@
 
 #include <format>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 
@@ -10,7 +11,7 @@
 #endif
 
 #define __ember_log_impl(level, target, fmt, ...) \
-    ember::util::log(ember::util::get_global_logger(), {target, level, __FUNCTION__, __FILE__, __LINE__}, fmt, ## __VA_ARGS__)
+    ember::util::log(ember::util::get_current_logger(), {target, level, __FUNCTION__, __FILE__, __LINE__}, fmt, ## __VA_ARGS__)
 
 #if EMBER_STATIC_LOG_LEVEL >= 0
 #define error(target, fmt, ...) \
@@ -71,6 +72,26 @@ namespace ember::util {
     void set_global_logger(std::unique_ptr<Logger> logger);
     Logger* get_global_logger();
 
+    // Logger the macros write to on the calling thread: the one of the innermost
+    // LogScope, else the global logger
+    Logger* get_current_logger();
+
+    // Route the logging of the calling thread to logger for the lifetime of the scope,
+    // so instances sharing threads (such as worlds of a WorldPool) keep their logs
+    // apart. Does nothing when logger is null.
+    class LogScope {
+    public:
+        explicit LogScope(Logger* logger);
+        ~LogScope();
+
+        LogScope(const LogScope&) = delete;
+        LogScope& operator=(const LogScope&) = delete;
+
+    private:
+        Logger* m_logger;
+        Logger* m_previous;
+    };
+
     void set_maximum_log_level(LogLevel level);
     LogLevel get_maximum_log_level();
 
@@ -91,9 +112,13 @@ namespace ember::util {
         __vlog(logger, manifest, fmt.get(), std::make_format_args(args...));
     }
 
+    // Safe to share between threads, each message is written in one piece
     class PrintfLogger : public Logger {
     public:
         virtual void write(const LogManifest& manifest, const std::string& msg) override;
+
+    private:
+        std::mutex m_mutex;
     };
 }
 
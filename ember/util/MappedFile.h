@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace ember::util {
+
+    // Read-only memory mapping of a whole file. The mapping starts on a page
+    // boundary so blocks aligned within the file are aligned in memory too.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other);
+        MappedFile& operator=(MappedFile&& other);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        inline std::span<const std::byte> data() const { return { m_data, m_size }; }
+        inline size_t size() const { return m_size; }
+
+    private:
+        const std::byte* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+
+        void close();
+    };
+
+}
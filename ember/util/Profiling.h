@@ -1,9 +1,113 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace ember::util {
 
+    // Records timed scopes from any number of threads. Each thread appends to its own
+    // buffer so recording never contends with other threads, only with an export.
+    // Keeps rolling statistics per scope name over the last few samples and the most
+    // recent events of every thread, which can be written out as a Chrome trace
+    // (chrome://tracing or ui.perfetto.dev both open it).
+    //
+    // Names and categories are stored as views: they must outlive the profiler, which
+    // string literals and names from intern() do.
+    class Profiler {
+    public:
+        using Clock = std::chrono::steady_clock;
 
+        struct Event {
+            std::string_view name;
+            std::string_view category;
+            Clock::time_point start;
+            Clock::time_point end;
+        };
 
-}
\ No newline at end of file
+        struct Stats {
+            size_t samples = 0;
+            Clock::duration mean = Clock::duration::zero();
+            Clock::duration p95 = Clock::duration::zero();
+            Clock::duration p99 = Clock::duration::zero();
+            Clock::duration max = Clock::duration::zero();
+        };
+
+        static constexpr size_t DEFAULT_WINDOW = 256;
+        static constexpr size_t DEFAULT_MAX_EVENTS = 1 << 16;
+
+        // Statistics cover the last `window` samples of every name, the trace the last
+        // `max_events` events of every thread
+        explicit Profiler(size_t window = DEFAULT_WINDOW, size_t max_events = DEFAULT_MAX_EVENTS);
+        ~Profiler();
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        void record(std::string_view name, std::string_view category, Clock::time_point start, Clock::time_point end);
+
+        // Copy name into storage owned by the profiler, returning the same view for
+        // equal names
+        std::string_view intern(std::string_view name);
+
+        Stats stats(std::string_view name) const;
+        // Statistics of every name recorded, sorted by name
+        std::vector<std::pair<std::string_view, Stats>> all_stats() const;
+
+        // Recorded events of every thread, each thread in the order they ended
+        std::vector<std::pair<uint32_t, Event>> events() const;
+
+        void write_chrome_trace(std::ostream& out) const;
+        void write_chrome_trace(const std::filesystem::path& path) const;
+
+        // Drop every event and sample recorded so far
+        void clear();
+
+    private:
+        struct ThreadBuffer;
+
+        uint64_t m_id;
+        size_t m_window;
+        size_t m_max_events;
+        Clock::time_point m_epoch;
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+        std::set<std::string, std::less<>> m_interned;
+
+        ThreadBuffer& thread_buffer();
+    };
+
+    // Times the enclosing scope. Does nothing, not even reading the clock, when the
+    // profiler is null.
+    class ProfileScope {
+    public:
+        ProfileScope(Profiler* profiler, std::string_view name, std::string_view category = {}):
+            m_profiler(profiler), m_name(name), m_category(category)
+        {
+            if (m_profiler) m_start = Profiler::Clock::now();
+        }
+
+        ~ProfileScope() {
+            if (m_profiler) m_profiler->record(m_name, m_category, m_start, Profiler::Clock::now());
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        Profiler* m_profiler;
+        std::string_view m_name;
+        std::string_view m_category;
+        Profiler::Clock::time_point m_start;
+    };
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ember::util {
+
+    // Work-stealing thread pool. Each worker owns a deque: it pushes and pops its own
+    // tasks LIFO for locality while idle workers steal FIFO from the others. Tasks
+    // submitted from outside the pool go to a shared injection queue.
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
+
+        static constexpr size_t NOT_A_WORKER = ~size_t(0);
+
+        // One worker per hardware thread, leaving one for the thread that submits work
+        static size_t default_worker_count();
+
+        explicit ThreadPool(size_t workers = default_worker_count());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        inline size_t worker_count() const { return m_worker_count; }
+
+        void submit(Task task);
+
+        // Run one pending task on the calling thread. Lets threads that wait on
+        // work help out instead of blocking, which also makes nested waits safe.
+        bool try_run_one();
+
+        // Index of the calling thread within this pool or NOT_A_WORKER
+        size_t worker_index() const;
+
+    private:
+        struct alignas(64) WorkQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        // Fixed before any worker starts so workers can read it without synchronization
+        const size_t m_worker_count;
+
+        // Queues [0, worker_count) belong to the workers, the last one is the injection queue
+        std::vector<std::unique_ptr<WorkQueue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake;
+        std::atomic<size_t> m_pending;
+        std::atomic<bool> m_stop;
+
+        void worker_loop(size_t index);
+        bool pop_task(size_t queue, Task& task, bool back);
+        bool find_task(size_t home, Task& task);
+    };
+
+    // A set of tasks that can be waited on together. wait() runs pending pool tasks on
+    // the waiting thread until every task of the group finished and rethrows the first
+    // exception raised by any of them. A group without a pool runs tasks inline.
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool* pool): m_pool(pool), m_outstanding(0) { }
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        void run(ThreadPool::Task task);
+        void wait();
+
+    private:
+        ThreadPool* m_pool;
+        std::atomic<size_t> m_outstanding;
+        std::mutex m_exception_mutex;
+        std::exception_ptr m_exception;
+
+        void capture_exception();
+    };
+
+}
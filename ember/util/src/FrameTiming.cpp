@@ -0,0 +1,62 @@
+#include "FrameTiming.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace ember::util {
+
+    FixedTimestep::FixedTimestep(float step, size_t max_substeps):
+        m_step(step), m_max_substeps(max_substeps)
+    {
+        if (!(step > 0.0f)) throw std::invalid_argument("Fixed timestep must be positive!");
+        if (max_substeps == 0) throw std::invalid_argument("Fixed timestep needs at least one substep!");
+    }
+
+    size_t FixedTimestep::advance(float dt) {
+        if (dt > 0.0f) m_accumulator += dt;
+
+        size_t steps = 0;
+        while ((m_accumulator >= m_step) && (steps < m_max_substeps)) {
+            m_accumulator -= m_step;
+            steps++;
+        }
+        if (m_accumulator >= m_step) {
+            // Fell too far behind, drop the backlog but keep the phase within the step
+            m_accumulator = std::fmod(m_accumulator, m_step);
+        }
+        return steps;
+    }
+
+    FrameLimiter::FrameLimiter(Clock::duration frame_time, Clock::duration spin_time):
+        m_frame_time(frame_time), m_spin_time(spin_time), m_deadline(Clock::now())
+    { }
+
+    FrameLimiter FrameLimiter::from_frame_rate(float frames_per_second) {
+        if (!(frames_per_second > 0.0f)) return FrameLimiter();
+        const auto frame_time = std::chrono::duration<double>(1.0 / frames_per_second);
+        return FrameLimiter(std::chrono::duration_cast<Clock::duration>(frame_time));
+    }
+
+    void FrameLimiter::wait() {
+        const auto now = Clock::now();
+        if (m_frame_time == Clock::duration::zero()) {
+            m_deadline = now;
+            return;
+        }
+
+        m_deadline += m_frame_time;
+        if (m_deadline <= now) {
+            m_deadline = now;
+            return;
+        }
+
+        if (m_deadline - now > m_spin_time) {
+            std::this_thread::sleep_for(m_deadline - now - m_spin_time);
+        }
+        while (Clock::now() < m_deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+}
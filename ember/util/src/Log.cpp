@@ -11,6 +11,7 @@ namespace ember::util {
         std::unique_ptr<Logger> logger = nullptr;
     };
     static GlobalLoggerState s_global_logger_state;
+    static thread_local Logger* t_scoped_logger = nullptr;
 
     void set_global_logger(std::unique_ptr<Logger> logger) {
         s_global_logger_state.logger = std::move(logger);
@@ -20,6 +21,18 @@ namespace ember::util {
         return s_global_logger_state.logger.get();
     }
 
+    Logger* get_current_logger() {
+        return t_scoped_logger ? t_scoped_logger : get_global_logger();
+    }
+
+    LogScope::LogScope(Logger* logger): m_logger(logger), m_previous(t_scoped_logger) {
+        if (m_logger) t_scoped_logger = m_logger;
+    }
+
+    LogScope::~LogScope() {
+        if (m_logger) t_scoped_logger = m_previous;
+    }
+
     void set_maximum_log_level(LogLevel level) {
         s_global_logger_state.max_log_level.store(level);
     }
@@ -42,13 +55,16 @@ namespace ember::util {
 
     void PrintfLogger::write(const LogManifest& manifest, const std::string& msg) {
         auto filename = std::filesystem::path(manifest.file).filename();
-        std::cout << std::format(
-            "[{}][{}][{}::{}] ",
+        const auto line = std::format(
+            "[{}][{}][{}::{}] {}\n",
             to_string(manifest.level),
             manifest.target,
             filename.string(),
-            manifest.lineno
+            manifest.lineno,
+            msg
         );
-        std::cout << msg <<std::endl;
+
+        std::lock_guard lock(m_mutex);
+        std::cout << line << std::flush;
     }
 }
\ No newline at end of file
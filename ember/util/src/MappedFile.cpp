@@ -0,0 +1,118 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ember::util {
+
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            m_file = nullptr;
+            throw std::runtime_error("Failed to open file!");
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size)) {
+            close();
+            throw std::runtime_error("Failed to read file size!");
+        }
+        m_size = size_t(size.QuadPart);
+        if (m_size == 0) return;
+
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const auto* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (view == nullptr) {
+            close();
+            throw std::runtime_error("Failed to map file!");
+        }
+        m_data = static_cast<const std::byte*>(view);
+    }
+
+    void MappedFile::close() {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file) CloseHandle(m_file);
+        m_data = nullptr;
+        m_mapping = m_file = nullptr;
+        m_size = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other):
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_file(std::exchange(other.m_file, nullptr)),
+        m_mapping(std::exchange(other.m_mapping, nullptr))
+    { }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) {
+        if (this != &other) {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_file = std::exchange(other.m_file, nullptr);
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+        }
+        return *this;
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        const auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Failed to open file!");
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to read file size!");
+        }
+        m_size = size_t(info.st_size);
+
+        // The mapping stays valid once the descriptor is closed
+        if (m_size != 0) {
+            const auto* view = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to map file!");
+            }
+            m_data = static_cast<const std::byte*>(view);
+        }
+        ::close(fd);
+    }
+
+    void MappedFile::close() {
+        if (m_data) ::munmap(const_cast<std::byte*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other):
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0))
+    { }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) {
+        if (this != &other) {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+#endif
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+}
@@ -0,0 +1,244 @@
+#include "Profiling.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace ember::util {
+
+    namespace {
+        std::atomic<uint64_t> s_next_profiler_id = 1;
+
+        // Buffer of the last profiler used on this thread. Profilers are identified by
+        // an id rather than their address so a new profiler never picks up a buffer
+        // left behind by a destroyed one.
+        struct CachedBuffer {
+            uint64_t profiler = 0;
+            void* buffer = nullptr;
+        };
+        thread_local CachedBuffer t_cached;
+
+        void write_json_string(std::ostream& out, std::string_view str) {
+            out << '"';
+            for (const auto c : str) {
+                switch (c) {
+                    case '"': out << "\\\""; break;
+                    case '\\': out << "\\\\"; break;
+                    case '\n': out << "\\n"; break;
+                    case '\t': out << "\\t"; break;
+                    default:
+                        if (uint8_t(c) < 0x20) {
+                            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+                        } else {
+                            out << c;
+                        }
+                }
+            }
+            out << '"';
+        }
+
+        // Nearest-rank percentile of sorted samples
+        Profiler::Clock::duration percentile(const std::vector<Profiler::Clock::duration>& sorted, double p) {
+            const auto rank = size_t(std::ceil(p * double(sorted.size()) - 1e-9));
+            return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+        }
+    }
+
+    struct Profiler::ThreadBuffer {
+        struct Samples {
+            std::vector<Clock::duration> values;
+            size_t next = 0;
+        };
+
+        std::thread::id thread;
+        uint32_t index;
+
+        // Only contended while another thread reads the buffer
+        std::mutex mutex;
+        // Ring buffer once full, next_event is then the oldest event
+        std::vector<Event> events;
+        size_t next_event = 0;
+        std::unordered_map<std::string_view, Samples> samples;
+    };
+
+    Profiler::Profiler(size_t window, size_t max_events):
+        m_id(s_next_profiler_id++),
+        m_window(std::max<size_t>(window, 1)),
+        m_max_events(std::max<size_t>(max_events, 1)),
+        m_epoch(Clock::now())
+    { }
+
+    Profiler::~Profiler() = default;
+
+    Profiler::ThreadBuffer& Profiler::thread_buffer() {
+        if (t_cached.profiler == m_id) return *static_cast<ThreadBuffer*>(t_cached.buffer);
+
+        std::lock_guard lock(m_mutex);
+        const auto thread = std::this_thread::get_id();
+        auto iter = std::find_if(m_threads.begin(), m_threads.end(), [&](const auto& buffer) {
+            return buffer->thread == thread;
+        });
+        if (iter == m_threads.end()) {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->thread = thread;
+            buffer->index = uint32_t(m_threads.size());
+            m_threads.push_back(std::move(buffer));
+            iter = m_threads.end() - 1;
+        }
+
+        t_cached = { m_id, iter->get() };
+        return **iter;
+    }
+
+    void Profiler::record(std::string_view name, std::string_view category, Clock::time_point start, Clock::time_point end) {
+        auto& buffer = thread_buffer();
+        std::lock_guard lock(buffer.mutex);
+
+        const Event event { name, category, start, end };
+        if (buffer.events.size() < m_max_events) {
+            buffer.events.push_back(event);
+        } else {
+            buffer.events[buffer.next_event] = event;
+            buffer.next_event = (buffer.next_event + 1) % m_max_events;
+        }
+
+        auto& samples = buffer.samples[name];
+        if (samples.values.size() < m_window) {
+            samples.values.push_back(end - start);
+        } else {
+            samples.values[samples.next] = end - start;
+            samples.next = (samples.next + 1) % m_window;
+        }
+    }
+
+    std::string_view Profiler::intern(std::string_view name) {
+        std::lock_guard lock(m_mutex);
+        auto iter = m_interned.find(name);
+        if (iter == m_interned.end()) iter = m_interned.emplace(name).first;
+        return *iter;
+    }
+
+    Profiler::Stats Profiler::stats(std::string_view name) const {
+        std::vector<Clock::duration> values;
+        {
+            std::lock_guard lock(m_mutex);
+            for (const auto& buffer : m_threads) {
+                std::lock_guard buffer_lock(buffer->mutex);
+                const auto iter = buffer->samples.find(name);
+                if (iter == buffer->samples.end()) continue;
+                values.insert(values.end(), iter->second.values.begin(), iter->second.values.end());
+            }
+        }
+
+        Stats stats;
+        if (values.empty()) return stats;
+
+        std::sort(values.begin(), values.end());
+        Clock::duration total = Clock::duration::zero();
+        for (const auto value : values) total += value;
+
+        stats.samples = values.size();
+        stats.mean = total / Clock::rep(values.size());
+        stats.p95 = percentile(values, 0.95);
+        stats.p99 = percentile(values, 0.99);
+        stats.max = values.back();
+        return stats;
+    }
+
+    std::vector<std::pair<std::string_view, Profiler::Stats>> Profiler::all_stats() const {
+        std::vector<std::string_view> names;
+        {
+            std::lock_guard lock(m_mutex);
+            for (const auto& buffer : m_threads) {
+                std::lock_guard buffer_lock(buffer->mutex);
+                for (const auto& [name, samples] : buffer->samples) names.push_back(name);
+            }
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+
+        std::vector<std::pair<std::string_view, Stats>> result;
+        result.reserve(names.size());
+        for (const auto name : names) {
+            result.emplace_back(name, stats(name));
+        }
+        return result;
+    }
+
+    std::vector<std::pair<uint32_t, Profiler::Event>> Profiler::events() const {
+        std::vector<std::pair<uint32_t, Event>> result;
+
+        std::lock_guard lock(m_mutex);
+        for (const auto& buffer : m_threads) {
+            std::lock_guard buffer_lock(buffer->mutex);
+            const auto count = buffer->events.size();
+            for (size_t i = 0; i < count; i++) {
+                result.emplace_back(buffer->index, buffer->events[(buffer->next_event + i) % count]);
+            }
+        }
+        return result;
+    }
+
+    void Profiler::write_chrome_trace(std::ostream& out) const {
+        const auto events = this->events();
+        uint32_t thread_count;
+        {
+            std::lock_guard lock(m_mutex);
+            thread_count = uint32_t(m_threads.size());
+        }
+
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        const auto fill = out.fill();
+        out << std::fixed << std::setprecision(3);
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        auto first = true;
+        for (uint32_t thread = 0; thread < thread_count; thread++) {
+            if (!first) out << ',';
+            first = false;
+            out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+                << ",\"args\":{\"name\":\"Thread " << thread << "\"}}";
+        }
+
+        using Microseconds = std::chrono::duration<double, std::micro>;
+        for (const auto& [thread, event] : events) {
+            if (!first) out << ',';
+            first = false;
+            out << "\n{\"name\":";
+            write_json_string(out, event.name);
+            out << ",\"cat\":";
+            write_json_string(out, event.category);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                << ",\"ts\":" << Microseconds(event.start - m_epoch).count()
+                << ",\"dur\":" << Microseconds(event.end - event.start).count() << '}';
+        }
+        out << "\n]}\n";
+
+        out.flags(flags);
+        out.precision(precision);
+        out.fill(fill);
+    }
+
+    void Profiler::write_chrome_trace(const std::filesystem::path& path) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("Failed to open file!");
+        write_chrome_trace(file);
+    }
+
+    void Profiler::clear() {
+        std::lock_guard lock(m_mutex);
+        for (const auto& buffer : m_threads) {
+            std::lock_guard buffer_lock(buffer->mutex);
+            buffer->events.clear();
+            buffer->next_event = 0;
+            buffer->samples.clear();
+        }
+    }
+
+}
@@ -0,0 +1,165 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace ember::util {
+
+    namespace {
+        struct WorkerIdentity {
+            const ThreadPool* pool = nullptr;
+            size_t index = ThreadPool::NOT_A_WORKER;
+        };
+        thread_local WorkerIdentity t_worker;
+    }
+
+    size_t ThreadPool::default_worker_count() {
+        const auto hw = std::thread::hardware_concurrency();
+        return (hw > 1) ? (hw - 1) : 1;
+    }
+
+    ThreadPool::ThreadPool(size_t workers): m_worker_count(workers), m_pending(0), m_stop(false) {
+        for (auto i = 0; i <= workers; i++) {
+            m_queues.push_back(std::make_unique<WorkQueue>());
+        }
+
+        m_threads.reserve(workers);
+        for (auto i = 0; i < workers; i++) {
+            m_threads.emplace_back([this, i]() { worker_loop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_sleep_mutex);
+            m_stop.store(true);
+        }
+        m_wake.notify_all();
+
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    size_t ThreadPool::worker_index() const {
+        return (t_worker.pool == this) ? t_worker.index : NOT_A_WORKER;
+    }
+
+    void ThreadPool::submit(Task task) {
+        const auto worker = worker_index();
+        const auto queue = (worker != NOT_A_WORKER) ? worker : worker_count();
+
+        // Count the task before publishing it so m_pending never underflows
+        m_pending.fetch_add(1);
+        {
+            std::lock_guard lock(m_queues[queue]->mutex);
+            m_queues[queue]->tasks.push_back(std::move(task));
+        }
+
+        // Taking the sleep mutex orders this wake after any worker that is
+        // between checking m_pending and going to sleep.
+        { std::lock_guard lock(m_sleep_mutex); }
+        m_wake.notify_one();
+    }
+
+    bool ThreadPool::pop_task(size_t queue, Task& task, bool back) {
+        auto& q = *m_queues[queue];
+        std::lock_guard lock(q.mutex);
+        if (q.tasks.empty()) return false;
+
+        if (back) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        m_pending.fetch_sub(1);
+        return true;
+    }
+
+    bool ThreadPool::find_task(size_t home, Task& task) {
+        // Own queue first (newest task, still warm in cache), then the
+        // injection queue, then steal the oldest task of another worker.
+        if ((home < worker_count()) && pop_task(home, task, true)) return true;
+        if (pop_task(worker_count(), task, false)) return true;
+
+        const auto workers = worker_count();
+        const auto start = (home < workers) ? home + 1 : 0;
+        for (auto i = 0; i < workers; i++) {
+            const auto victim = (start + i) % workers;
+            if ((victim != home) && pop_task(victim, task, false)) return true;
+        }
+        return false;
+    }
+
+    bool ThreadPool::try_run_one() {
+        if (m_pending.load() == 0) return false;
+
+        Task task;
+        if (!find_task(worker_index(), task)) return false;
+        task();
+        return true;
+    }
+
+    void ThreadPool::worker_loop(size_t index) {
+        t_worker = WorkerIdentity { this, index };
+
+        while (true) {
+            Task task;
+            if (find_task(index, task)) {
+                task();
+                continue;
+            }
+
+            std::unique_lock lock(m_sleep_mutex);
+            m_wake.wait(lock, [this]() { return m_stop.load() || (m_pending.load() > 0); });
+            if (m_stop.load() && (m_pending.load() == 0)) return;
+        }
+    }
+
+    TaskGroup::~TaskGroup() {
+        // Tasks reference the group so it must outlive them, but a destructor
+        // must not throw so any exception is dropped here.
+        try {
+            wait();
+        } catch (...) { }
+    }
+
+    void TaskGroup::capture_exception() {
+        std::lock_guard lock(m_exception_mutex);
+        if (!m_exception) m_exception = std::current_exception();
+    }
+
+    void TaskGroup::run(ThreadPool::Task task) {
+        if (m_pool == nullptr) {
+            try {
+                task();
+            } catch (...) {
+                capture_exception();
+            }
+            return;
+        }
+
+        m_outstanding.fetch_add(1);
+        m_pool->submit([this, task = std::move(task)]() {
+            try {
+                task();
+            } catch (...) {
+                capture_exception();
+            }
+            m_outstanding.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    void TaskGroup::wait() {
+        while (m_outstanding.load(std::memory_order_acquire) != 0) {
+            if (!m_pool->try_run_one()) std::this_thread::yield();
+        }
+
+        std::exception_ptr exception;
+        {
+            std::lock_guard lock(m_exception_mutex);
+            std::swap(exception, m_exception);
+        }
+        if (exception) std::rethrow_exception(exception);
+    }
+
+}
@@ -0,0 +1,57 @@
+#include <cmath>
+#include <stdexcept>
+#include <catch2/catch_test_macros.hpp>
+
+#include "FrameTiming.h"
+
+using namespace ember::util;
+
+TEST_CASE("FixedTimestep::advance() runs whole steps and keeps the remainder", "[FixedTimestep]") {
+    auto timestep = FixedTimestep(0.01f);
+    REQUIRE(timestep.advance(0.025f) == 2);
+    REQUIRE(std::abs(timestep.alpha() - 0.5f) < 1e-4f);
+
+    REQUIRE(timestep.advance(0.004f) == 0);
+    REQUIRE(std::abs(timestep.alpha() - 0.9f) < 1e-4f);
+
+    REQUIRE(timestep.advance(0.002f) == 1);
+    REQUIRE(std::abs(timestep.alpha() - 0.1f) < 1e-4f);
+}
+
+TEST_CASE("FixedTimestep::advance() caps the number of substeps", "[FixedTimestep]") {
+    auto timestep = FixedTimestep(0.01f, 4);
+    REQUIRE(timestep.advance(1.0f) == 4);
+    REQUIRE(timestep.alpha() < 1.0f);
+
+    // The backlog was dropped rather than carried over
+    REQUIRE(timestep.advance(0.0f) == 0);
+}
+
+TEST_CASE("FixedTimestep() rejects invalid steps", "[FixedTimestep]") {
+    REQUIRE_THROWS_AS(FixedTimestep(0.0f), std::invalid_argument);
+    REQUIRE_THROWS_AS(FixedTimestep(0.01f, 0), std::invalid_argument);
+}
+
+TEST_CASE("FrameLimiter::wait() paces frames to the target frame time", "[FrameLimiter]") {
+    using namespace std::chrono_literals;
+    auto limiter = FrameLimiter(5ms);
+
+    const auto start = FrameLimiter::Clock::now();
+    limiter.wait();
+    for (auto i = 0; i < 4; i++) {
+        limiter.wait();
+    }
+    REQUIRE(FrameLimiter::Clock::now() - start >= 20ms);
+}
+
+TEST_CASE("FrameLimiter without a frame time never waits", "[FrameLimiter]") {
+    using namespace std::chrono_literals;
+    auto limiter = FrameLimiter::from_frame_rate(0.0f);
+    REQUIRE(limiter.frame_time() == FrameLimiter::Clock::duration::zero());
+
+    const auto start = FrameLimiter::Clock::now();
+    for (auto i = 0; i < 100; i++) {
+        limiter.wait();
+    }
+    REQUIRE(FrameLimiter::Clock::now() - start < 5ms);
+}
@@ -1,4 +1,5 @@
 #include <array>
+#include <thread>
 #include <catch2/catch_test_macros.hpp>
 
 #include "Log.h"
@@ -32,3 +33,27 @@ TEST_CASE("ember log macros write manifest, fmt and args to logger vformat funct
     REQUIRE(logger->manifest.lineno == 420);
     REQUIRE(logger->msg == "Hello, World");
 }
+
+TEST_CASE("LogScope routes the calling thread's logging until it ends", "[Log]") {
+    TestLogger outer;
+    TestLogger inner;
+    auto* global = get_global_logger();
+    REQUIRE(get_current_logger() == global);
+
+    {
+        LogScope outer_scope(&outer);
+        REQUIRE(get_current_logger() == &outer);
+        {
+            LogScope inner_scope(&inner);
+            LogScope null_scope(nullptr);
+            REQUIRE(get_current_logger() == &inner);
+        }
+        REQUIRE(get_current_logger() == &outer);
+
+        // Other threads keep the global logger
+        Logger* other = nullptr;
+        std::thread([&]() { other = get_current_logger(); }).join();
+        REQUIRE(other == global);
+    }
+    REQUIRE(get_current_logger() == global);
+}
@@ -0,0 +1,32 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <catch2/catch_test_macros.hpp>
+
+#include "MappedFile.h"
+
+using namespace ember::util;
+
+TEST_CASE("MappedFile maps the contents of a file", "[MappedFile]") {
+    const auto path = std::filesystem::temp_directory_path() / "ember_test_mapped_file.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "mapped contents";
+    }
+
+    auto file = MappedFile(path);
+    REQUIRE(file.size() == 15);
+    REQUIRE(std::memcmp(file.data().data(), "mapped contents", 15) == 0);
+    REQUIRE(reinterpret_cast<uintptr_t>(file.data().data()) % 64 == 0);
+
+    auto moved = std::move(file);
+    REQUIRE(moved.size() == 15);
+    REQUIRE(file.size() == 0);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFile throws if the file does not exist", "[MappedFile]") {
+    REQUIRE_THROWS_AS(MappedFile("/this/file/does/not/exist"), std::runtime_error);
+}
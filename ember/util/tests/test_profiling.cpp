@@ -0,0 +1,90 @@
+#include <sstream>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+
+#include "Profiling.h"
+
+using namespace ember::util;
+using namespace std::chrono_literals;
+
+TEST_CASE("Profiler::stats() summarizes the recorded durations", "[Profiler]") {
+    Profiler profiler;
+    const auto start = Profiler::Clock::now();
+    for (auto i = 1; i <= 100; i++) {
+        profiler.record("scope", "test", start, start + std::chrono::microseconds(i));
+    }
+
+    const auto stats = profiler.stats("scope");
+    REQUIRE(stats.samples == 100);
+    REQUIRE(stats.mean == std::chrono::nanoseconds(50500));
+    REQUIRE(stats.p95 == 95us);
+    REQUIRE(stats.p99 == 99us);
+    REQUIRE(stats.max == 100us);
+
+    REQUIRE(profiler.stats("missing").samples == 0);
+}
+
+TEST_CASE("Profiler keeps a rolling window of samples and events", "[Profiler]") {
+    Profiler profiler(10, 4);
+    const auto start = Profiler::Clock::now();
+    for (auto i = 1; i <= 20; i++) {
+        profiler.record("scope", "test", start, start + std::chrono::microseconds(i));
+    }
+
+    // Only the last 10 samples count
+    const auto stats = profiler.stats("scope");
+    REQUIRE(stats.samples == 10);
+    REQUIRE(stats.max == 20us);
+    REQUIRE(stats.mean == std::chrono::nanoseconds(15500));
+
+    // And the trace keeps the 4 most recent events, oldest first
+    const auto events = profiler.events();
+    REQUIRE(events.size() == 4);
+    REQUIRE(events.front().second.end - events.front().second.start == 17us);
+    REQUIRE(events.back().second.end - events.back().second.start == 20us);
+
+    profiler.clear();
+    REQUIRE(profiler.events().empty());
+    REQUIRE(profiler.all_stats().empty());
+}
+
+TEST_CASE("Profiler records every thread into its own buffer", "[Profiler]") {
+    Profiler profiler;
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            for (auto i = 0; i < 100; i++) {
+                ProfileScope scope(&profiler, "work", "test");
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    const auto events = profiler.events();
+    REQUIRE(events.size() == 400);
+    std::vector<uint32_t> counts(4, 0);
+    for (const auto& [thread, event] : events) {
+        REQUIRE(thread < 4);
+        counts[thread]++;
+    }
+    REQUIRE(counts == std::vector<uint32_t>(4, 100));
+    REQUIRE(profiler.stats("work").samples == 400);
+}
+
+TEST_CASE("Profiler::write_chrome_trace() writes trace events", "[Profiler]") {
+    Profiler profiler;
+    const auto name = profiler.intern(std::string("phase \"0\""));
+    REQUIRE(profiler.intern("phase \"0\"").data() == name.data());
+    {
+        ProfileScope scope(&profiler, name, "phase");
+    }
+    ProfileScope disabled(nullptr, "disabled");
+
+    std::stringstream out;
+    profiler.write_chrome_trace(out);
+    const auto trace = out.str();
+    REQUIRE(trace.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    REQUIRE(trace.find("\"name\":\"phase \\\"0\\\"\",\"cat\":\"phase\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(trace.find("\"thread_name\"") != std::string::npos);
+    REQUIRE(trace.find("disabled") == std::string::npos);
+}
@@ -0,0 +1,64 @@
+#include <atomic>
+#include <stdexcept>
+#include <catch2/catch_test_macros.hpp>
+
+#include "ThreadPool.h"
+
+using namespace ember::util;
+
+TEST_CASE("ThreadPool() creates the requested number of workers", "[ThreadPool]") {
+    auto pool = ThreadPool(3);
+    REQUIRE(pool.worker_count() == 3);
+    REQUIRE(pool.worker_index() == ThreadPool::NOT_A_WORKER);
+}
+
+TEST_CASE("TaskGroup::wait() returns after every task ran", "[ThreadPool]") {
+    auto pool = ThreadPool(4);
+    std::atomic<int> counter = 0;
+
+    TaskGroup group(&pool);
+    for (auto i = 0; i < 1000; i++) {
+        group.run([&]() { counter++; });
+    }
+    group.wait();
+
+    REQUIRE(counter == 1000);
+}
+
+TEST_CASE("TaskGroup::wait() can be nested inside pool tasks", "[ThreadPool]") {
+    auto pool = ThreadPool(2);
+    std::atomic<int> counter = 0;
+
+    TaskGroup outer(&pool);
+    for (auto i = 0; i < 8; i++) {
+        outer.run([&]() {
+            TaskGroup inner(&pool);
+            for (auto j = 0; j < 8; j++) {
+                inner.run([&]() { counter++; });
+            }
+            inner.wait();
+        });
+    }
+    outer.wait();
+
+    REQUIRE(counter == 64);
+}
+
+TEST_CASE("TaskGroup runs tasks on the waiting thread when the pool has no workers", "[ThreadPool]") {
+    auto pool = ThreadPool(0);
+    int counter = 0;
+
+    TaskGroup group(&pool);
+    group.run([&]() { counter++; });
+    group.wait();
+
+    REQUIRE(counter == 1);
+}
+
+TEST_CASE("TaskGroup::wait() rethrows task exceptions", "[ThreadPool]") {
+    auto pool = ThreadPool(2);
+
+    TaskGroup group(&pool);
+    group.run([]() { throw std::runtime_error("task failed"); });
+    REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+}